@@ -67,6 +67,10 @@ namespace so {
             str = s.data();
             len = s.length();
         }
+
+        operator std::string_view() const {
+            return std::string_view(str, len);
+        }
 #endif
 
         friend std::ostream &operator<<(std::ostream &os, const Slice &slice) {
@@ -0,0 +1,270 @@
+#ifndef ALLOCATOR_H
+#define ALLOCATOR_H
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#if __cplusplus >= 201103L
+#include <atomic>
+#endif
+
+/*
+ * Allocators for my::vector and anything else that takes one.
+ *
+ * my::malloc_allocator<T> is the default: it hands out malloc'd blocks, so a vector of trivially
+ * relocatable elements can still grow with realloc (see my::realloc_with).
+ *
+ * my::memory_resource is an abstract source of bytes, as std::pmr::memory_resource, and
+ * my::polymorphic_allocator<T> allocates from whichever resource it is given, so containers that
+ * draw from different resources still have the same type. my::monotonic_buffer_resource is a bump
+ * arena over chunks taken from an upstream resource: allocation moves a pointer, deallocation does
+ * nothing, and release() or the destructor gives every chunk back at once. It suits short lived
+ * containers, e.g. everything built while handling one request, and is not thread safe.
+ *
+ *     my::monotonic_buffer_resource arena(64 * 1024);
+ *     my::vector<int, my::polymorphic_allocator<int> > v(&arena);
+ */
+
+namespace my {
+    template <class T> class malloc_allocator;
+    class memory_resource;
+    class monotonic_buffer_resource;
+    template <class T> class polymorphic_allocator;
+
+    /*----------alignment of T, also in C++98----------*/
+    template <class T> struct alignment_of {
+    #if __cplusplus >= 201103L
+        static const size_t value = alignof(T);
+    #else
+        struct holder {char c; T t;};
+        static const size_t value = sizeof(holder) - sizeof(T);
+    #endif
+    };
+    // the alignment malloc guarantees
+    #if __cplusplus >= 201103L
+    static const size_t max_align = alignof(std::max_align_t);
+    #else
+    static const size_t max_align = 2 * sizeof(void*);
+    #endif
+
+    /*----------resize p from old_n to n elements in place of allocate, copy, deallocate----------*/
+    // NULL means the allocator cannot: only a malloc'd block can be handed to realloc
+    template <class A, class T> T* realloc_with(A&, T*, size_t, size_t) {return NULL;}
+    template <class T> T* realloc_with(malloc_allocator<T>&, T* p, size_t, size_t n) {
+        if (n > (size_t)-1 / sizeof(T)) throw std::bad_alloc();
+        T* temp = (T*)realloc((void*)p, sizeof(T)*n);
+        if (temp == NULL) throw std::bad_alloc();
+        return temp;
+    }
+
+    memory_resource* malloc_resource();
+    memory_resource* get_default_resource();
+    memory_resource* set_default_resource(memory_resource* r);
+}
+
+template <class T>
+class my::malloc_allocator {
+    public:
+    typedef T value_type;
+    typedef T* pointer;
+    typedef const T* const_pointer;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef size_t size_type;
+    typedef std::ptrdiff_t difference_type;
+    template <class U> struct rebind {typedef malloc_allocator<U> other;};
+
+    malloc_allocator() {}
+    template <class U> malloc_allocator(const malloc_allocator<U>&) {}
+
+    T* allocate(size_t n) {
+        if (n > (size_t)-1 / sizeof(T)) throw std::bad_alloc();
+        T* p = (T*)malloc(sizeof(T)*n);
+        if (p == NULL) throw std::bad_alloc();
+        return p;
+    }
+    void deallocate(T* p, size_t) {free(p);}
+
+    template <class U> bool operator==(const malloc_allocator<U>&) const {return true;}
+    template <class U> bool operator!=(const malloc_allocator<U>&) const {return false;}
+};
+
+/*----------a source of raw memory, as std::pmr::memory_resource----------*/
+class my::memory_resource {
+    public:
+    virtual ~memory_resource() {}
+    void* allocate(size_t bytes, size_t align = max_align) {return do_allocate(bytes, align);}
+    void deallocate(void* p, size_t bytes, size_t align = max_align) {do_deallocate(p, bytes, align);}
+    bool is_equal(const memory_resource& r) const {return this == &r || do_is_equal(r);}
+
+    private:
+    virtual void* do_allocate(size_t bytes, size_t align) = 0;
+    virtual void do_deallocate(void* p, size_t bytes, size_t align) = 0;
+    virtual bool do_is_equal(const memory_resource& r) const = 0;
+};
+
+namespace my {
+    /* malloc and free; a block aligned past max_align keeps malloc's pointer just below it */
+    class malloc_memory_resource: public memory_resource {
+        void* do_allocate(size_t bytes, size_t align) {
+            if (align <= max_align) {
+                void* p = malloc(bytes);
+                if (p == NULL) throw std::bad_alloc();
+                return p;
+            }
+            char* raw = (char*)malloc(bytes + align + sizeof(void*));
+            if (raw == NULL) throw std::bad_alloc();
+            char* p = raw + sizeof(void*);
+            p += (align - (size_t)p % align) % align;
+            ((void**)p)[-1] = raw;
+            return p;
+        }
+        void do_deallocate(void* p, size_t, size_t align) {
+            if (p != NULL && align > max_align) p = ((void**)p)[-1];
+            free(p);
+        }
+        bool do_is_equal(const memory_resource& r) const {
+            return dynamic_cast<const malloc_memory_resource*>(&r) != NULL;
+        }
+    };
+    inline memory_resource* malloc_resource() {
+        static malloc_memory_resource r;
+        return &r;
+    }
+    /* the resource a default constructed polymorphic_allocator uses, malloc_resource() unless set */
+    #if __cplusplus >= 201103L
+    inline std::atomic<memory_resource*>& default_resource() {
+        static std::atomic<memory_resource*> r(malloc_resource());
+        return r;
+    }
+    #else
+    inline memory_resource*& default_resource() {
+        static memory_resource* r = malloc_resource();
+        return r;
+    }
+    #endif
+    inline memory_resource* get_default_resource() {return default_resource();}
+    /* returns the previous default; NULL restores malloc_resource() */
+    inline memory_resource* set_default_resource(memory_resource* r) {
+        if (r == NULL) r = malloc_resource();
+    #if __cplusplus >= 201103L
+        return default_resource().exchange(r);
+    #else
+        memory_resource* old = default_resource();
+        default_resource() = r;
+        return old;
+    #endif
+    }
+}
+
+/*
+ * Bump allocation out of chunks from upstream. Each new chunk is twice the size of the last, so
+ * n bytes take O(log n) upstream calls; a first buffer may be supplied, e.g. an array on the stack.
+ */
+class my::monotonic_buffer_resource: public my::memory_resource {
+    public:
+    explicit monotonic_buffer_resource(memory_resource* up = get_default_resource()):
+        upstream(up), chunks(NULL), cur(NULL), end(NULL), initial(NULL), initial_size(0), first_chunk(1024) {
+        next_size = first_chunk;
+    }
+    explicit monotonic_buffer_resource(size_t size, memory_resource* up = get_default_resource()):
+        upstream(up), chunks(NULL), cur(NULL), end(NULL), initial(NULL), initial_size(0), first_chunk(size > 64? size: 64) {
+        next_size = first_chunk;
+    }
+    monotonic_buffer_resource(void* buffer, size_t size, memory_resource* up = get_default_resource()):
+        upstream(up), chunks(NULL), cur((char*)buffer), end((char*)buffer + size), initial((char*)buffer),
+        initial_size(size), first_chunk(size > 512? 2 * size: 1024) {
+        next_size = first_chunk;
+    }
+    ~monotonic_buffer_resource() {release();}
+
+    /* gives every chunk back to upstream and starts again from the initial buffer, if any */
+    void release() {
+        while (chunks != NULL) {
+            chunk* next = chunks->next;
+            upstream->deallocate(chunks, chunks->size);
+            chunks = next;
+        }
+        cur = initial; end = initial + initial_size;
+        next_size = first_chunk;
+    }
+    memory_resource* upstream_resource() const {return upstream;}
+
+    private:
+    struct chunk {
+        chunk* next;
+        size_t size;
+    };
+    memory_resource* upstream;
+    chunk* chunks;
+    char* cur;
+    char* end;
+    char* initial;
+    size_t initial_size;
+    size_t first_chunk;
+    size_t next_size;
+
+    // not copyable
+    monotonic_buffer_resource(const monotonic_buffer_resource&);
+    monotonic_buffer_resource& operator=(const monotonic_buffer_resource&);
+
+    void* do_allocate(size_t bytes, size_t align) {
+        if (bytes == 0) bytes = 1;
+        size_t pad = (align - (size_t)cur % align) % align;
+        if (pad + bytes > (size_t)(end - cur)) {
+            grow(bytes, align);
+            pad = (align - (size_t)cur % align) % align;
+        }
+        char* p = cur + pad;
+        cur = p + bytes;
+        return p;
+    }
+    void do_deallocate(void*, size_t, size_t) {}
+    bool do_is_equal(const memory_resource& r) const {return this == &r;}
+
+    void grow(size_t bytes, size_t align) {
+        size_t size = sizeof(chunk) + bytes + align;
+        if (size < next_size) size = next_size;
+        chunk* c = (chunk*)upstream->allocate(size, max_align);
+        c->next = chunks; c->size = size;
+        chunks = c;
+        cur = (char*)(c + 1);
+        end = (char*)c + size;
+        next_size = size * 2;
+    }
+};
+
+/*----------allocates T's from a memory_resource, as std::pmr::polymorphic_allocator----------*/
+template <class T>
+class my::polymorphic_allocator {
+    public:
+    typedef T value_type;
+    typedef T* pointer;
+    typedef const T* const_pointer;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef size_t size_type;
+    typedef std::ptrdiff_t difference_type;
+    template <class U> struct rebind {typedef polymorphic_allocator<U> other;};
+
+    polymorphic_allocator(): res(get_default_resource()) {}
+    polymorphic_allocator(memory_resource* r): res(r) {}
+    template <class U> polymorphic_allocator(const polymorphic_allocator<U>& a): res(a.resource()) {}
+
+    T* allocate(size_t n) {
+        if (n > (size_t)-1 / sizeof(T)) throw std::bad_alloc();
+        return (T*)res->allocate(sizeof(T)*n, alignment_of<T>::value);
+    }
+    void deallocate(T* p, size_t n) {res->deallocate(p, sizeof(T)*n, alignment_of<T>::value);}
+    memory_resource* resource() const {return res;}
+    /* a copied container goes back to the default resource rather than sharing this one */
+    polymorphic_allocator select_on_container_copy_construction() const {return polymorphic_allocator();}
+
+    template <class U> bool operator==(const polymorphic_allocator<U>& a) const {return res->is_equal(*a.resource());}
+    template <class U> bool operator!=(const polymorphic_allocator<U>& a) const {return !(*this == a);}
+
+    private:
+    memory_resource* res;
+};
+
+#endif
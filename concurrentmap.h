@@ -0,0 +1,200 @@
+#ifndef CONCURRENTMAP_H
+#define CONCURRENTMAP_H
+
+#if __cplusplus < 201103L
+#error "concurrentmap.h requires C++11"
+#endif
+
+#include <mutex>
+#include <stdexcept>
+#if __cplusplus >= 201703L
+#include <shared_mutex>
+#endif
+#include "hashmap.h"
+
+/*
+ * A my::map split into N independently locked shards. A key's shard is chosen from the top bits of
+ * its hash (the shard's own table uses the low bits), so unrelated keys rarely share a lock.
+ * With C++17 each shard has a reader/writer lock and lookups on the same shard run in parallel.
+ * Values are returned by copy, or handed to a callback while the shard is locked, since a reference
+ * into a shard cannot outlive its lock.
+ */
+
+namespace my {
+    template <class K, class V, class C = my::equals<K>, class H = hash, size_t N = 64> class concurrent_map;
+}
+template <class K, class V, class C, class H, size_t N>
+class my::concurrent_map {
+    static_assert(N > 0 && N <= 65536 && (N & (N - 1)) == 0, "shard count must be a power of two");
+    #if __cplusplus >= 201703L
+    typedef std::shared_mutex mutex_type;
+    typedef std::shared_lock<mutex_type> read_lock;
+    #else
+    typedef std::mutex mutex_type;
+    typedef std::unique_lock<mutex_type> read_lock;
+    #endif
+    typedef std::unique_lock<mutex_type> write_lock;
+
+    // one cache line per lock so that shards do not false-share
+    struct alignas(64) shard {
+        mutable mutex_type lock;
+        my::map<K, V, C, H> m;
+    };
+    public:
+    typedef size_t size_type;
+    typedef std::pair<const K, V> value_type;
+
+    concurrent_map(const C& compfunc = C(), const H& hashfunc = H()): hash(hashfunc) {
+        for (size_t i = 0; i < N; ++i)
+            shards[i].m = my::map<K, V, C, H>(compfunc, hashfunc);
+    }
+    concurrent_map(std::initializer_list<value_type> l): concurrent_map() {insert(l);}
+
+    template <class InputIterator>
+    concurrent_map(InputIterator first, InputIterator last): concurrent_map() {insert(first, last);}
+
+    concurrent_map(const concurrent_map&) = delete;
+    concurrent_map& operator=(const concurrent_map&) = delete;
+
+    bool insert(const value_type& p) {
+        shard& s = shard_of(p.first);
+        write_lock l(s.lock);
+        return s.m.insert(p).second;
+    }
+    template <class InputIterator>
+    void insert(InputIterator first, InputIterator last) {
+        for (; first != last; ++first)
+            insert(*first);
+    }
+    void insert(std::initializer_list<value_type> l) {insert(l.begin(), l.end());}
+
+    bool insert(value_type&& p) {
+        shard& s = shard_of(p.first);
+        write_lock l(s.lock);
+        return s.m.insert(std::move(p)).second;
+    }
+    template <class... Args>
+    bool emplace(Args&&... args) {
+        // the shard is only known once the key exists, so build the pair before locking
+        value_type p(std::forward<Args>(args)...);
+        return insert(std::move(p));
+    }
+    template <class... Args>
+    bool try_emplace(const K& key, Args&&... args) {
+        shard& s = shard_of(key);
+        write_lock l(s.lock);
+        return s.m.try_emplace(key, std::forward<Args>(args)...).second;
+    }
+    template <class M>
+    bool insert_or_assign(const K& key, M&& obj) {
+        shard& s = shard_of(key);
+        write_lock l(s.lock);
+        return s.m.insert_or_assign(key, std::forward<M>(obj)).second;
+    }
+
+    void erase(const K& val) {erase_key(val);}
+
+    /* copies the value into out and returns true if the key is present */
+    bool find(const K& val, V& out) const {return find_key(val, out);}
+
+    bool contains(const K& val) const {return contains_key(val);}
+
+    V at(const K& val) const {
+        V out;
+        if (!find_key(val, out)) throw std::out_of_range("concurrent_map::at() Key not found!");
+        return out;
+    }
+    #if __cplusplus >= 201703L
+    template <class Key, class HH = H, class = typename HH::is_transparent, class CC = C, class = typename CC::is_transparent>
+    void erase(const Key& val) {erase_key(val);}
+
+    template <class Key, class HH = H, class = typename HH::is_transparent, class CC = C, class = typename CC::is_transparent>
+    bool find(const Key& val, V& out) const {return find_key(val, out);}
+
+    template <class Key, class HH = H, class = typename HH::is_transparent, class CC = C, class = typename CC::is_transparent>
+    bool contains(const Key& val) const {return contains_key(val);}
+    #endif
+    /* Calls f(value) with the shard locked for writing, inserting V() first if the key is absent.
+     * This replaces operator[], whose reference would escape the lock. */
+    template <class F>
+    void update(const K& val, F f) {
+        shard& s = shard_of(val);
+        write_lock l(s.lock);
+        f(s.m[val]);
+    }
+    /* Calls f(value) with the shard locked for writing if the key is present. */
+    template <class F>
+    bool visit(const K& val, F f) {
+        shard& s = shard_of(val);
+        write_lock l(s.lock);
+        value_type* p = s.m.find(val);
+        if (p == NULL) return false;
+        f(p->second);
+        return true;
+    }
+    /* Calls f(pair) for every entry, one shard at a time; entries inserted meanwhile may be missed. */
+    template <class F>
+    void for_each(F f) {
+        for (size_t i = 0; i < N; ++i) {
+            write_lock l(shards[i].lock);
+            for (typename my::map<K, V, C, H>::iterator it = shards[i].m.begin(); it != shards[i].m.end(); ++it)
+                f(*it);
+        }
+    }
+    /* the sum over all shards, exact only when no writer is running */
+    size_t size() const {
+        size_t n = 0;
+        for (size_t i = 0; i < N; ++i) {
+            read_lock l(shards[i].lock);
+            n += shards[i].m.size();
+        }
+        return n;
+    }
+    bool empty() const {return size() == 0;}
+
+    void reserve(size_t n) {
+        for (size_t i = 0; i < N; ++i) {
+            write_lock l(shards[i].lock);
+            shards[i].m.reserve(n / N + 1);
+        }
+    }
+    void clear() {
+        for (size_t i = 0; i < N; ++i) {
+            write_lock l(shards[i].lock);
+            shards[i].m.clear();
+        }
+    }
+    static size_t shard_count() {return N;}
+
+    private:
+    mutable shard shards[N];
+    H hash;
+
+    template <class Key>
+    shard& shard_of(const Key& val) const {
+        return shards[(hash(val) >> (sizeof(size_t) * 8 - 16)) & (N - 1)];
+    }
+    template <class Key>
+    void erase_key(const Key& val) {
+        shard& s = shard_of(val);
+        write_lock l(s.lock);
+        s.m.erase(val);
+    }
+    template <class Key>
+    bool find_key(const Key& val, V& out) const {
+        shard& s = shard_of(val);
+        read_lock l(s.lock);
+        value_type* p = s.m.find(val);
+        if (p == NULL) return false;
+        out = p->second;
+        return true;
+    }
+    template <class Key>
+    bool contains_key(const Key& val) const {
+        shard& s = shard_of(val);
+        read_lock l(s.lock);
+        return s.m.find(val) != NULL;
+    }
+};
+
+#endif
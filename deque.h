@@ -4,6 +4,7 @@
 #include <iostream>
 #include <cstdlib>
 #include "utilities.h"
+#include "sort.h"
 
 namespace my {
     template <class T> class deque;
@@ -89,9 +90,27 @@ class my::deque {
     void shrink_to_fit();
     void swap(deque& vec);
     void clear();
-    void sort() {quickSort(0, size()-1, my::less<T>());}
+    void sort() {
+        if (empty()) return;
+        T* first = linearize();  // may move arr, so before reading it
+        my::sort(first, arr+tail+1);
+    }
     template <class C>
-    void sort(C compare) {quickSort(0, size()-1, compare);}
+    void sort(C compare) {
+        if (empty()) return;
+        T* first = linearize();  // may move arr, so before reading it
+        my::sort(first, arr+tail+1, compare);
+    }
+    #if __cplusplus >= 201103L
+    /* sorts on up to threads threads (0: one per core); small deques are sorted as by sort() */
+    void parallel_sort(unsigned threads = 0) {parallel_sort(my::less<T>(), threads);}
+    template <class C, class = typename std::enable_if<!std::is_integral<C>::value>::type>
+    void parallel_sort(C compare, unsigned threads = 0) {
+        if (empty()) return;
+        T* first = linearize();  // may move arr, so before reading it
+        my::parallel_sort(first, arr+tail+1, compare, threads);
+    }
+    #endif
     iterator find(iterator begin, iterator end, const T& val);
     iterator find_s(iterator begin, iterator end, const T& val);  //uses binary search
     iterator begin() const {return iterator(0, this);}
@@ -126,10 +145,7 @@ class my::deque {
     size_t tail;
     void growArray(size_t n);
     bool isFull();
-    template <class C>
-    size_t partition(size_t l, size_t h, const C& comp);
-    template <class C>
-    void quickSort(size_t low, size_t high, const C& comp);
+    T* linearize();
 };
 template <class T>
 bool my::deque<T>::isFull() {
@@ -323,7 +339,7 @@ template <class T>
 void my::deque<T>::push_front(const T& val) {
     if (size_ == 0) {
         size_ = 10;
-        arr = new T [size_];
+        arr = (T*)malloc(sizeof(T)*size_);
     }
     else if (isFull()) growArray(size_);
     if (head == -1) {
@@ -339,7 +355,7 @@ template <class T>
 void my::deque<T>::push_back(const T& val) {
     if (size_ == 0) {
         size_ = 10;
-        arr = new T [size_];
+        arr = (T*)malloc(sizeof(T)*size_);
     }
     else if (isFull()) growArray(size_);
     if (tail == -1) {
@@ -363,20 +379,9 @@ deque_iterator<T> my::deque<T>::insert(iterator it, const T& val, size_t n) {
         (*this)[i] = val;
     return iterator(this, begin);
 }
-template <class InputIterator>
-size_t distance(InputIterator first, InputIterator& last, std::random_access_iterator_tag) {
-    return last - first;
-}
-template <class InputIterator>
-size_t distance(InputIterator first, InputIterator& last, typename std::iterator_traits<InputIterator>::iterator_category) {
-    int n = 0;
-    for (; first != last; ++first)
-        n++;
-    return n;
-}
 template <class T> template<class InputIterator>
 void my::deque<T>::insert(iterator it, InputIterator begin, InputIterator end) {
-    size_t n = distance(begin, end, typename std::iterator_traits<InputIterator>::iterator_category());
+    size_t n = my::distance(begin, end, typename std::iterator_traits<InputIterator>::iterator_category());
     this->resize(size()+n);
     size_t first = it.ptr;
     size_t last = first + n - 1;
@@ -449,30 +454,12 @@ void my::deque<T>::pop_back() {
     else
         --tail; 
 }
-template <class T> template <class C>
-size_t my::deque<T>::partition(size_t l, size_t h, const C& comp) {
-    bool done = false;
-    int midpoint = l + (h - l) / 2;
-    T pivot = (*this)[midpoint];
-    while (!done) {
-        while (comp((*this)[l], pivot)) ++l;
-        while (comp(pivot, (*this)[h])) --h;
-        if (l >= h)
-            done = true;
-        else {
-            my::swap((*this)[l], (*this)[h]);
-            ++l; --h;
-        }
-    }
-    return h;
-}
-template <class T> template <class C>
-void my::deque<T>::quickSort(size_t l, size_t h, const C& comp) {
-    if (l >= h)
-        return;
-    int m = partition(l, h, comp);
-    quickSort(l, m, comp);
-    quickSort(m + 1, h, comp);
+/* Makes the elements one contiguous run, unwrapping the ring if needed, and returns its start. */
+template <class T>
+T* my::deque<T>::linearize() {
+    if (head > tail)
+        growArray(0);
+    return arr+head;
 }
 template <class T> class my::deque<T>::
 deque_iterator<T> my::deque<T>::find(iterator begin, iterator end, const T& val) {
@@ -507,16 +494,6 @@ std::ostream& my::operator << (std::ostream& os, const my::deque<T>& dq) {
     os << "]" << std::endl;
     return os;
 }
-template <class InputIterator1, class InputIterator2>
-  bool lexicographicalCompare (InputIterator1 first1, InputIterator1 last1,
-                                InputIterator2 first2, InputIterator2 last2) {
-    while (first1!=last1) {
-        if (first2==last2 || *first2<*first1) return false;
-        else if (*first1<*first2) return true;
-        ++first1; ++first2;
-    }
-    return (first2!=last2);
-}
 template <class T>
 bool operator==(my::deque<T>& d1, my::deque<T>& d2) {
     if (d1.size() != d2.size())
@@ -533,7 +510,7 @@ bool operator!=(my::deque<T>& d1, my::deque<T>& d2) {
 }
 template <class T>
 bool operator<(my::deque<T>& d1, my::deque<T>& d2) {
-    return(lexicographicalCompare(d1.begin(), d1.end(), d2.begin(), d2.end()));
+    return(my::lexicographicalCompare(d1.begin(), d1.end(), d2.begin(), d2.end()));
 }
 template <class T>
 bool operator<=(my::deque<T>& d1, my::deque<T>& d2) {
@@ -0,0 +1,131 @@
+#ifndef HASH_H
+#define HASH_H
+
+#include <string>
+#include <cstring>
+#if __cplusplus >= 201703L
+#include <string_view>
+#endif
+
+/*
+ * Hash functions for the hash maps. Every my::hash result is a full width value that does not
+ * depend on the table size, so a table with a power of two bucket count can just mask the low bits.
+ * The mixing follows wyhash (public domain): multiply two 64 bit words to 128 bits and fold the halves.
+ * To hash your own types, pass a functor with size_t operator()(const K&) as the map's H parameter;
+ * my::hash_mix and my::hash_bytes are the building blocks used here.
+ */
+
+namespace my {
+    namespace detail {
+        typedef unsigned long long u64;
+        const u64 hash_secret[4] = {0xa0761d6478bd642fULL, 0xe7037ed1a0b428dbULL,
+                                    0x8ebc6af09c88c6e3ULL, 0x589965cc75374cc3ULL};
+
+        /*----------64x64 -> 128 bit multiply, a and b receive the low and high halves----------*/
+        inline void mum(u64& a, u64& b) {
+        #if defined(__SIZEOF_INT128__)
+            __uint128_t r = (__uint128_t)a * b;
+            a = (u64)r; b = (u64)(r >> 64);
+        #else
+            u64 ha = a >> 32, hb = b >> 32, la = (unsigned)a, lb = (unsigned)b;
+            u64 rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+            u64 t = rl + (rm0 << 32), c = t < rl;
+            u64 lo = t + (rm1 << 32);
+            c += lo < t;
+            a = lo; b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+        #endif
+        }
+        inline u64 mix(u64 a, u64 b) {mum(a, b); return a ^ b;}
+
+        inline u64 read8(const unsigned char* p) {u64 v; memcpy(&v, p, 8); return v;}
+        inline u64 read4(const unsigned char* p) {unsigned v; memcpy(&v, p, 4); return v;}
+        inline u64 read3(const unsigned char* p, size_t k) {
+            return ((u64)p[0] << 16) | ((u64)p[k >> 1] << 8) | p[k - 1];
+        }
+    }
+    /*----------scramble one word so that every input bit affects every output bit----------*/
+    inline size_t hash_mix(unsigned long long x) {
+        return (size_t)detail::mix(x ^ detail::hash_secret[0], detail::hash_secret[1]);
+    }
+    /*----------hash a run of bytes, eight or more bytes at a time----------*/
+    inline size_t hash_bytes(const void* data, size_t len, unsigned long long seed = 0) {
+        using namespace detail;
+        const unsigned char* p = (const unsigned char*)data;
+        const u64* s = hash_secret;
+        seed ^= mix(seed ^ s[0], s[1]);
+        u64 a, b;
+        if (len <= 16) {
+            if (len >= 4) {
+                a = (read4(p) << 32) | read4(p + ((len >> 3) << 2));
+                b = (read4(p + len - 4) << 32) | read4(p + len - 4 - ((len >> 3) << 2));
+            }
+            else if (len > 0) {
+                a = read3(p, len); b = 0;
+            }
+            else
+                a = b = 0;
+        }
+        else {
+            size_t i = len;
+            if (i > 48) {
+                u64 see1 = seed, see2 = seed;
+                do {
+                    seed = mix(read8(p) ^ s[1], read8(p + 8) ^ seed);
+                    see1 = mix(read8(p + 16) ^ s[2], read8(p + 24) ^ see1);
+                    see2 = mix(read8(p + 32) ^ s[3], read8(p + 40) ^ see2);
+                    p += 48; i -= 48;
+                } while (i > 48);
+                seed ^= see1 ^ see2;
+            }
+            while (i > 16) {
+                seed = mix(read8(p) ^ s[1], read8(p + 8) ^ seed);
+                i -= 16; p += 16;
+            }
+            a = read8(p + i - 16); b = read8(p + i - 8);
+        }
+        a ^= s[1]; b ^= seed;
+        mum(a, b);
+        return (size_t)mix(a ^ s[0] ^ len, b ^ s[1]);
+    }
+    struct hash {
+        typedef void is_transparent;
+        size_t operator()(bool x) const {return hash_mix(x);}
+        size_t operator()(char x) const {return hash_mix(x);}
+        size_t operator()(signed char x) const {return hash_mix(x);}
+        size_t operator()(unsigned char x) const {return hash_mix(x);}
+        size_t operator()(wchar_t x) const {return hash_mix(x);}
+        size_t operator()(short x) const {return hash_mix(x);}
+        size_t operator()(unsigned short x) const {return hash_mix(x);}
+        size_t operator()(int x) const {return hash_mix(x);}
+        size_t operator()(unsigned int x) const {return hash_mix(x);}
+        size_t operator()(long x) const {return hash_mix(x);}
+        size_t operator()(unsigned long x) const {return hash_mix(x);}
+        size_t operator()(long long x) const {return hash_mix(x);}
+        size_t operator()(unsigned long long x) const {return hash_mix(x);}
+        // equal values must hash equally, so 0.0 and -0.0 share the bit pattern of 0.0
+        size_t operator()(double d) const {
+            if (d == 0) d = 0;
+            unsigned long long bits;
+            memcpy(&bits, &d, sizeof(bits));
+            return hash_mix(bits);
+        }
+        size_t operator()(float f) const {return (*this)((double)f);}
+        size_t operator()(long double d) const {return (*this)((double)d);}
+        template <class T>
+        size_t operator()(T* p) const {return hash_mix((unsigned long long)(size_t)p);}
+        size_t operator()(const char* s) const {return hash_bytes(s, strlen(s));}
+        // a plain char* is a string too, not a pointer for the template above
+        size_t operator()(char* s) const {return hash_bytes(s, strlen(s));}
+        size_t operator()(const std::string& s) const {return hash_bytes(s.data(), s.size());}
+    #if __cplusplus >= 201703L
+        // also picks up anything convertible to a string_view, e.g. so::Slice
+        size_t operator()(std::string_view s) const {return hash_bytes(s.data(), s.size());}
+    #endif
+
+        /*----------reduce to [0, size), for callers of the old two argument form----------*/
+        template <class T>
+        size_t operator()(const T& t, size_t size) const {return (*this)(t) % size;}
+    };
+}
+
+#endif
@@ -2,68 +2,158 @@
 #define HASHMAP_H
 
 #include <iostream>
+#include <iterator>
 #include <stdexcept>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#if __cplusplus >= 201103L
+#include <type_traits>
+#include <tuple>
+#endif
 #include "utilities.h" //for equals
+#include "hash.h"
+
+/* Define MY_HASHMAP_STATS before including this header to have every my::map count its lookups,
+ * chain probes and rehashes; see map::stats(). Without it the counting code is not compiled at all. */
+#ifdef MY_HASHMAP_STATS
+#if __cplusplus >= 201103L
+#include <atomic>
+#include <chrono>
+#else
+#include <ctime>
+#endif
+#define MY_HASHMAP_COUNT(stmt) stmt
+#else
+#define MY_HASHMAP_COUNT(stmt)
+#endif
 
 namespace my{
-    /*----------get default size for table----------------*/
-    template <class T> size_t default_size() {return 100000;}
-    template <> size_t default_size<char>() {return 95;}
-    struct hash {
-        template<class T> size_t operator()(T t, size_t size);
-    };
-    template <> size_t hash::operator() (std::string, size_t);
-    template <> size_t hash::operator() (const char* s, size_t);
-    template <> size_t my::hash::operator() (double d, size_t size);
-    template <> size_t my::hash::operator() (long double d, size_t size);
-    template <> size_t hash::operator() (float, size_t);
-    template <> size_t hash::operator() (char, size_t);
+    /*----------get default size for table, a power of two that doubles as the map grows----------------*/
+    template <class T> size_t default_size() {return 8;}
+    inline size_t next_pow2(size_t n) {
+        size_t p = 1;
+        while (p < n) p <<= 1;
+        return p;
+    }
     template <class T> struct HashNode;
-    template <class K, class V, class C = my::equals<K>, class H = hash> class map;
-}
-/*-------------------for integer data types------------------*/
-template <class T> size_t my::hash::operator() (T t, size_t size) {
-    return (size_t)t % size;
-}
-template <> size_t my::hash::operator() (double d, size_t size) {
-    d *= 100; return (size_t)d % size;
-}
-template <> size_t my::hash::operator() (long double d, size_t size) {
-    d *= 100; return (size_t)d % size;
-}
-template <> size_t my::hash::operator() (float f, size_t size) {
-    f *= 100; return (size_t)f % size;
-}
-template <> size_t my::hash::operator() (std::string s, size_t size) {
-    const size_t p = 31;
-    size_t hash_value = 0;
-    unsigned long long p_pow = 1;
-    for (int i = 0; i < s.size(); ++i) {
-        hash_value = (hash_value + (s[i] - ' ' + 1) * p_pow) % size;
-        p_pow = (p_pow * p) % size;
-    }
-    return hash_value;
-}
-template <> size_t my::hash::operator() (const char* s, size_t size) {
-    const size_t p = 31;
-    size_t hash_value = 0;
-    unsigned long long p_pow = 1;
-    for (int i = 0; s[i] != '\0'; i++) {
-        hash_value = (hash_value + (s[i] - ' ' + 1) * p_pow) % size;
-        p_pow = (p_pow * p) % size;
-    }
-    return hash_value;
-}
-template <> size_t my::hash::operator() (char s, size_t size) {
-    return (size_t)(s - ' ') % size;
+    struct map_stats;
+    template <class T, class A = std::allocator<T> > class node_pool;
+    template <class K, class V, class C = my::equals<K>, class H = hash,
+              class A = std::allocator<std::pair<const K, V> > > class map;
 }
+/*----------what map::stats() reports----------*/
+struct my::map_stats {
+    size_t buckets;             // during an incremental rehash this includes the old table
+    size_t entries;
+    size_t used_buckets;        // buckets holding at least one entry
+    size_t max_chain;
+    double load_factor;
+    double avg_chain;           // mean length of the non-empty chains
+    size_t chain_histogram[9];  // [i] = buckets with a chain of length i, the last one counts 8 or more
+    // the fields below stay 0 unless MY_HASHMAP_STATS is defined
+    unsigned long long finds;   // lookups, including the ones made by insert and erase
+    unsigned long long probes;  // keys compared during those lookups
+    unsigned long long rehashes;
+    double rehash_seconds;      // time spent moving nodes to a new table
+    double probes_per_find() const {return (finds == 0)? 0: (double)probes / finds;}
+};
 template <class T>
 struct my::HashNode {
     T data;
     HashNode* next;
-    HashNode(T t): data(t), next(NULL) {}
+    HashNode(const T& t): data(t), next(NULL) {}
+    #if __cplusplus >= 201103L
+    template <class... Args>
+    HashNode(Args&&... args): data(std::forward<Args>(args)...), next(NULL) {}
+    #endif
+};
+/*
+ * Hands out uninitialised storage for one T at a time from slabs obtained through A.
+ * Slabs double in size up to max_slab objects, freed objects are kept on a free list for reuse,
+ * and release() returns every slab at once, so a container never frees its nodes one by one.
+ */
+template <class T, class A>
+class my::node_pool {
+    #if __cplusplus >= 201103L
+    typedef typename std::allocator_traits<A>::template rebind_alloc<T> allocator_type;
+    #else
+    typedef typename A::template rebind<T>::other allocator_type;
+    #endif
+    // the first object(s) of every slab are used for this header
+    struct slab {
+        slab* next;
+        size_t size;
+    };
+    struct free_node {
+        free_node* next;
+    };
+    static const size_t min_slab = 16;
+    static const size_t max_slab = 4096;
+    static const size_t header = (sizeof(slab) + sizeof(T) - 1) / sizeof(T);
+
+    public:
+    explicit node_pool(const A& a = A()): alloc(a), slabs(NULL), free_list(NULL), cur(NULL), end(NULL), next_size(min_slab) {}
+    ~node_pool() {release();}
+
+    T* allocate() {
+        if (free_list != NULL) {
+            free_node* n = free_list;
+            free_list = n->next;
+            return reinterpret_cast<T*>(n);
+        }
+        if (cur == end) grow();
+        return cur++;
+    }
+    void deallocate(T* p) {
+        free_node* n = reinterpret_cast<free_node*>(p);
+        n->next = free_list;
+        free_list = n;
+    }
+    /* Returns all slabs to the allocator; objects still in them must already be destroyed. */
+    void release() {
+        while (slabs != NULL) {
+            slab* next = slabs->next;
+            size_t size = slabs->size;
+            alloc.deallocate(reinterpret_cast<T*>(slabs), size);
+            slabs = next;
+        }
+        free_list = NULL; cur = end = NULL;
+        next_size = min_slab;
+    }
+    void swap(node_pool& p) {
+        my::swap(alloc, p.alloc);
+        my::swap(slabs, p.slabs);
+        my::swap(free_list, p.free_list);
+        my::swap(cur, p.cur);
+        my::swap(end, p.end);
+        my::swap(next_size, p.next_size);
+    }
+    A get_allocator() const {return A(alloc);}
+
+    private:
+    allocator_type alloc;
+    slab* slabs;
+    free_node* free_list;
+    T* cur;
+    T* end;
+    size_t next_size;
+
+    node_pool(const node_pool&);
+    node_pool& operator=(const node_pool&);
+
+    void grow() {
+        size_t size = next_size + header;
+        T* mem = alloc.allocate(size);
+        slab* s = reinterpret_cast<slab*>(mem);
+        s->next = slabs; s->size = size;
+        slabs = s;
+        cur = mem + header; end = mem + size;
+        if (next_size < max_slab) next_size *= 2;
+    }
 };
-template <class K, class V, class C, class H>
+template <class K, class V, class C, class H, class A>
 class my::map {
     template <class T> class map_iterator {
         public:
@@ -73,16 +163,14 @@ class my::map {
         typedef std::forward_iterator_tag iterator_category;
         typedef void difference_type;
         map_iterator(map* a = NULL, size_t i = 0, HashNode<std::pair<const K, V> >* h = NULL) {m = a; index = i; p = h;}
-        map_iterator& operator=(const map_iterator& it) {m = it.m; index = it.index; p = it.p;}
         bool operator==(const map_iterator& it) {return p == it.p;}
         bool operator!=(const map_iterator& it) {return p != it.p;}
         map_iterator& operator++() {
             if (p->next != NULL)
                 p = p->next;
             else {
-                ++index;
-                while (index < m->size_ && m->arr[index] == NULL) ++index;
-                p = (index == m->size_)? NULL: m->arr[index];
+                index = m->next_bucket(index + 1);
+                p = (index == m->bucket_total())? NULL: m->bucket(index);
             }
             return *this;
         }
@@ -96,18 +184,19 @@ class my::map {
         HashNode<std::pair<const K, V> >* p;
     };
     void copy(const map& m) {
-        for (size_t i = 0; i < m.size_; ++i) {
-            HashNode<value_type>* temp = m.arr[i];
+        for (size_t i = 0; i < m.bucket_total(); ++i) {
+            HashNode<value_type>* temp = m.bucket(i);
             while (temp != NULL) {
                 insert(temp->data);
                 temp = temp->next;
             }
         }
     }
+    /* The bucket array is followed by an occupancy bitmap with one bit per non-empty bucket,
+     * so iteration can skip 64 empty buckets per word instead of testing each one. */
     void init() {
-        arr = new HashNode<value_type>*[size_];
-        for (size_t i = 0; i < size_; ++i)
-            arr[i] = NULL;
+        // calloc lets large tables come straight from zeroed pages instead of a zeroing loop
+        arr = (HashNode<value_type>**)calloc(1, table_bytes(size_));
     }
     public:
     typedef size_t size_type;
@@ -115,116 +204,142 @@ class my::map {
     typedef map_iterator<value_type> iterator;
     typedef map_iterator<const value_type> const_iterator;
 
-    map(size_t size, const C& compfunc = C(), const H& hashfunc = H()): arr(NULL), size_(size), count(0) {
+    /* size is the initial bucket count (rounded up to a power of two); like every other constructor, no buckets are
+     * allocated until the first insert, and the table doubles from there as needed. */
+    map(size_t size, const C& compfunc = C(), const H& hashfunc = H(), const A& alloc = A()): arr(NULL), count(0),
+        size_(next_pow2(size)), old(NULL), old_size(0), migrated(0), max_load(1.0f), pool(alloc) {
         hash = hashfunc;
         comp = compfunc;
     }
-    map(const C& compfunc = C(), const H& hashfunc = H()): arr(NULL), size_(default_size<K>()), count(0) {
+    map(const C& compfunc = C(), const H& hashfunc = H(), const A& alloc = A()): arr(NULL), count(0),
+        size_(default_size<K>()), old(NULL), old_size(0), migrated(0), max_load(1.0f), pool(alloc) {
         hash = hashfunc;
         comp = compfunc;
     }
     #if __cplusplus >= 201103L
-    map(std::initializer_list<value_type> l): size_(default_size<K>()), count(0) {
-        init();
+    map(std::initializer_list<value_type> l): arr(NULL), count(0), size_(default_size<K>()),
+        old(NULL), old_size(0), migrated(0), max_load(1.0f) {
+        reserve(l.size());
         insert(l);
     }
     map(map&& m) {
         arr = m.arr; m.arr = NULL;
         count = m.count; m.count = 0;
         size_ = m.size_;
+        old = m.old; m.old = NULL;
+        old_size = m.old_size; m.old_size = 0;
+        migrated = m.migrated; m.migrated = 0;
+        max_load = m.max_load;
         hash = m.hash;
         comp = m.comp;
+        pool.swap(m.pool);
     }
     #endif
 
     template <class InputIterator>
-    map(InputIterator first, InputIterator last): size_(default_size<K>()), count(0) {
-        init();
+    map(InputIterator first, InputIterator last): arr(NULL), count(0), size_(default_size<K>()),
+        old(NULL), old_size(0), migrated(0), max_load(1.0f) {
         insert(first, last);
     }
-    map(const map& m): size_(m.size_), count(0), hash(m.hash), comp(m.comp) {
-        init();
+    map(const map& m): arr(NULL), count(0), size_(default_size<K>()), old(NULL), old_size(0), migrated(0),
+        max_load(m.max_load), hash(m.hash), comp(m.comp), pool(m.pool.get_allocator()) {
+        reserve(m.count);
         copy(m);
     }
-    ~map() {clear(); delete [] arr;}
+    ~map() {clear(); free(arr);}
 
     std::pair<value_type*, bool> insert(const value_type& p) {
-        if (arr == NULL) init();
-
-        size_t index = hash(p.first, size_);
-        if (arr[index] == NULL) {
-            arr[index] = new HashNode<value_type>(p);
-            ++count;
-            return std::pair<value_type*, bool>(&(arr[index]->data), true);
-        }
-        else {
-            HashNode<value_type>* temp = arr[index], *prev;
-            while (temp != NULL) {
-                if (comp(temp->data.first, p.first))
-                    return std::pair<value_type*, bool>(&(temp->data), false);
-                prev = temp;
-                temp = temp->next;
-            }
-            prev->next = new HashNode<value_type>(p);
-            ++count;
-            return std::pair<value_type*, bool>(&(prev->next->data), true);
-        }
+        size_t h;
+        value_type* found = prepare_insert(p.first, h);
+        if (found != NULL)
+            return std::pair<value_type*, bool>(found, false);
+        return std::pair<value_type*, bool>(link_node(create_node(p), h), true);
     }
+    /* Forward ranges are counted first so the table is sized once, up front, instead of
+     * doubling (and incrementally rehashing) its way through a bulk load. */
     template <class InputIterator>
     void insert(InputIterator first, InputIterator last) {
-        for (; first != last; ++first)
-            insert(*first);
+        insert_range(first, last, typename std::iterator_traits<InputIterator>::iterator_category());
     }
     #if __cplusplus >= 201103L
-    void insert(std::initializer_list<value_type> l) {
-        for (auto it = l.begin(); it != l.end(); it++)
-            insert(*it);
+    void insert(std::initializer_list<value_type> l) {insert(l.begin(), l.end());}
+    std::pair<value_type*, bool> insert(value_type&& p) {
+        size_t h;
+        value_type* found = prepare_insert(p.first, h);
+        if (found != NULL)
+            return std::pair<value_type*, bool>(found, false);
+        return std::pair<value_type*, bool>(link_node(create_node(std::move(p)), h), true);
     }
+    /* The pair is built directly in its node; the key is only known afterwards,
+     * so if it is already present the node is destroyed again. */
     template <class... Args>
     std::pair<value_type*, bool> emplace(Args&&... args) {
-        return insert(value_type(args...));
-    }
-    #endif
-    void erase(const K& val) {
-        size_t index = hash(val, size_);
-        if (arr[index] != NULL) {
-            HashNode<value_type>* temp = arr[index], *prev;
-            if (comp(temp->data.first, val)) {
-                arr[index] = arr[index]->next;
-                delete temp; count--; return;
-            }
-            while (temp != NULL && !comp(temp->data.first, val)) { 
-                prev = temp;
-                temp = temp->next; 
-            }
-            if (temp == NULL) return; 
-            prev->next = temp->next;
-            delete temp; count--;
+        HashNode<value_type>* node = create_node(std::forward<Args>(args)...);
+        size_t h;
+        value_type* found = prepare_insert(node->data.first, h);
+        if (found != NULL) {
+            destroy_node(node);
+            return std::pair<value_type*, bool>(found, false);
         }
+        return std::pair<value_type*, bool>(link_node(node, h), true);
     }
-    value_type* find(K val) {
-        size_t index = hash(val, size_);
-        if (arr[index] != NULL) {
-            HashNode<value_type>* temp = arr[index];
-            while (temp != NULL) {
-                if (comp(temp->data.first, val))
-                    return &(temp->data);
-                temp = temp->next; 
-            }
-        }
-        return NULL;
+    /* Constructs the value from args only if the key is absent. */
+    template <class... Args>
+    std::pair<value_type*, bool> try_emplace(const K& key, Args&&... args) {
+        return emplace_key(key, std::forward<Args>(args)...);
     }
-    V& at(const K& val) {
-        value_type* p = find(val);
-        if (p == NULL) throw std::out_of_range("map::at() Key not found!");
-        return p->second;
+    template <class... Args>
+    std::pair<value_type*, bool> try_emplace(K&& key, Args&&... args) {
+        return emplace_key(std::move(key), std::forward<Args>(args)...);
+    }
+    template <class M>
+    std::pair<value_type*, bool> insert_or_assign(const K& key, M&& obj) {
+        return assign_key(key, std::forward<M>(obj));
     }
+    template <class M>
+    std::pair<value_type*, bool> insert_or_assign(K&& key, M&& obj) {
+        return assign_key(std::move(key), std::forward<M>(obj));
+    }
+    #endif
+    void erase(const K& val) {erase_key(val);}
+
+    value_type* find(const K& val) {return find_key(val);}
+
+    /* Looks up n keys at once, storing a pointer to each entry (or NULL) in out. The loop runs
+     * a short pipeline: a key's bucket slot is prefetched, then its first node, and only then is
+     * the chain walked, so the cache misses of neighbouring keys overlap instead of serialising. */
+    void find_many(const K* keys, size_t n, value_type** out) {find_many_keys(keys, n, out);}
+
+    V& at(const K& val) {return at_key(val);}
+
+    #if __cplusplus >= 201703L
+    /* Heterogeneous lookup: when both H and C declare is_transparent (as my::hash and
+     * my::equals<std::string> do), a std::string key can be looked up by a std::string_view,
+     * const char* or so::Slice without building a temporary std::string. */
+    template <class Key, class HH = H, class = typename HH::is_transparent, class CC = C, class = typename CC::is_transparent>
+    void erase(const Key& val) {erase_key(val);}
+
+    template <class Key, class HH = H, class = typename HH::is_transparent, class CC = C, class = typename CC::is_transparent>
+    value_type* find(const Key& val) {return find_key(val);}
+
+    template <class Key, class HH = H, class = typename HH::is_transparent, class CC = C, class = typename CC::is_transparent>
+    void find_many(const Key* keys, size_t n, value_type** out) {find_many_keys(keys, n, out);}
+
+    template <class Key, class HH = H, class = typename HH::is_transparent, class CC = C, class = typename CC::is_transparent>
+    V& at(const Key& val) {return at_key(val);}
+    #endif
+    #if __cplusplus >= 201103L
+    V& operator[](const K& val) {return try_emplace(val).first->second;}
+
+    V& operator[](K&& val) {return try_emplace(std::move(val)).first->second;}
+    #else
     V& operator[](const K& val) {
         value_type* p = find(val);
         if (p != NULL)
             return p->second;
         return insert(value_type(val, V())).first->second;
     }
+    #endif
     #if __cplusplus >= 201103L
     map& operator=(std::initializer_list<value_type> l) {
         clear();
@@ -234,13 +349,19 @@ class my::map {
     map& operator=(map&& m) {
         if (this != &m) {
             clear();
-            delete [] arr;
+            free(arr);
             arr = m.arr; m.arr = NULL;
             count = m.count; m.count = 0;
             size_ = m.size_;
+            old = m.old; m.old = NULL;
+            old_size = m.old_size; m.old_size = 0;
+            migrated = m.migrated; m.migrated = 0;
+            max_load = m.max_load;
             hash = m.hash;
             comp = m.comp;
+            pool.swap(m.pool);
         }
+        return *this;
     }
     #endif
     map& operator=(const map& m) {
@@ -257,38 +378,93 @@ class my::map {
 
     bool empty() {return count == 0;}
 
+    size_t bucket_count() const {return size_;}
+
+    float load_factor() const {return (float)count / size_;}
+
+    float max_load_factor() const {return max_load;}
+
+    void max_load_factor(float ml) {max_load = ml;}
+
+    /* Rebuilds the table with at least n buckets, rounded up to a power of two (and enough to respect max_load_factor) in one go.
+     * Growth triggered by insert is incremental instead: see start_rehash(). */
+    void rehash(size_t n) {
+        finish_rehash();
+        size_t needed = (size_t)(count / max_load) + 1;
+        if (n < needed) n = needed;
+        n = next_pow2(n);
+        if (arr == NULL) {
+            size_ = n;
+            return;
+        }
+        start_rehash(n);
+        finish_rehash();
+    }
+    void reserve(size_t n) {
+        size_t buckets = (size_t)(n / max_load) + 1;
+        if (buckets > size_) rehash(buckets);
+    }
+    /* Walks the table to describe its shape, which costs O(bucket_count()); a histogram bunched at
+     * the high end, or a max_chain far above avg_chain, points at a weak hash for these keys.
+     * Like find(), stats() only reads the map, so it may run alongside other readers, e.g. under
+     * concurrent_map's shared lock (the find and probe counters are atomic with C++11), but not
+     * alongside a writer. */
+    map_stats stats() const {
+        map_stats st;
+        memset(&st, 0, sizeof(st));
+        st.buckets = (arr == NULL)? 0: size_ + old_size;
+        st.entries = count;
+        st.load_factor = (st.buckets == 0)? 0: (double)count / st.buckets;
+        for (size_t i = 0; i < bucket_total(); ++i) {
+            size_t len = 0;
+            for (HashNode<value_type>* temp = bucket(i); temp != NULL; temp = temp->next)
+                ++len;
+            ++st.chain_histogram[(len < 8)? len: 8];
+            if (len > st.max_chain) st.max_chain = len;
+            if (len > 0) ++st.used_buckets;
+        }
+        st.avg_chain = (st.used_buckets == 0)? 0: (double)count / st.used_buckets;
+        #ifdef MY_HASHMAP_STATS
+        st.finds = counters.finds.get();
+        st.probes = counters.probes.get();
+        st.rehashes = counters.rehashes;
+        st.rehash_seconds = counters.rehash_seconds;
+        #endif
+        return st;
+    }
+    void reset_stats() {MY_HASHMAP_COUNT(counters = stat_counters();)}
+
+    /* Destroys the entries (skipped when that is a no-op) and hands the node slabs back in one go. */
     void clear() {
         if (count != 0) {
-            for (size_t i = 0; i < size_; i++) {
-                if (arr[i] != NULL) {
-                    HashNode<value_type>* temp = arr[i], *next;
-                    while (temp != NULL) {
-                        next = temp->next;
-                        delete temp;
-                        temp = next;
-                    }
-                    arr[i] = NULL;
+        #if __cplusplus >= 201103L
+            if (!std::is_trivially_destructible<value_type>::value)
+        #endif
+            for (size_t i = 0; i < bucket_total(); i++) {
+                HashNode<value_type>* temp = bucket(i), *next;
+                while (temp != NULL) {
+                    next = temp->next;
+                    temp->~HashNode<value_type>();
+                    temp = next;
                 }
             }
+            memset(arr, 0, table_bytes(size_));
         }
+        free(old);
+        old = NULL; old_size = 0; migrated = 0;
         count = 0;
+        pool.release();
     }
     iterator begin() {
-        if (arr[0] != NULL)
-            return iterator(this, 0, arr[0]);
-        size_t i = 0;
-        while (i < size_ && arr[i] == NULL) ++i;
-        if (i == size_) return iterator();
-        return iterator(this, i, arr[i]);
+        size_t i = next_bucket(0);
+        if (i == bucket_total()) return iterator();
+        return iterator(this, i, bucket(i));
     }
     iterator end() {return iterator();}
     const_iterator cbegin() {
-        if (arr[0] != NULL)
-            return const_iterator(this, 0, arr[0]);
-        size_t i = 0;
-        while (i < size_ && arr[i] == NULL) ++i;
-        if (i == size_) return const_iterator();
-        return const_iterator(this, i, arr[i]);
+        size_t i = next_bucket(0);
+        if (i == bucket_total()) return const_iterator();
+        return const_iterator(this, i, bucket(i));
     }
     const_iterator cend() {return const_iterator();}
 
@@ -296,8 +472,285 @@ class my::map {
     HashNode<value_type>** arr;
     size_t count;
     size_t size_;
+    /* While the table grows, the previous bucket array is kept in old and drained a few
+     * buckets per insert/erase; buckets below migrated have already been moved to arr. */
+    HashNode<value_type>** old;
+    size_t old_size;
+    size_t migrated;
+    float max_load;
     H hash;
     C comp;
+    node_pool<HashNode<value_type>, A> pool;
+
+    #ifdef MY_HASHMAP_STATS
+    /* find() counts under a shared lock in concurrent_map, so lookups count atomically (relaxed,
+     * C++11); rehashes only happen under a write lock and are plain counters */
+    struct stat_count {
+    #if __cplusplus >= 201103L
+        std::atomic<unsigned long long> n;
+        stat_count(): n(0) {}
+        stat_count(const stat_count& c): n(c.get()) {}
+        stat_count& operator=(const stat_count& c) {n.store(c.get(), std::memory_order_relaxed); return *this;}
+        void operator++() {n.fetch_add(1, std::memory_order_relaxed);}
+        unsigned long long get() const {return n.load(std::memory_order_relaxed);}
+    #else
+        unsigned long long n;
+        stat_count(): n(0) {}
+        void operator++() {++n;}
+        unsigned long long get() const {return n;}
+    #endif
+    };
+    struct stat_counters {
+        stat_count finds, probes;
+        unsigned long long rehashes;
+        double rehash_seconds;
+        stat_counters(): rehashes(0), rehash_seconds(0) {}
+    } counters;
+    /* adds the lifetime of the timer to total */
+    struct stat_timer {
+        double& total;
+        #if __cplusplus >= 201103L
+        std::chrono::steady_clock::time_point start;
+        stat_timer(double& t): total(t), start(std::chrono::steady_clock::now()) {}
+        ~stat_timer() {total += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();}
+        #else
+        clock_t start;
+        stat_timer(double& t): total(t), start(clock()) {}
+        ~stat_timer() {total += (double)(clock() - start) / CLOCKS_PER_SEC;}
+        #endif
+    };
+    #endif
+
+    static const size_t rehash_batch = 8;
+    static const size_t prefetch_distance = 8;  // keys between find_many's pipeline stages
+
+    /* Iteration walks the unmigrated part of old, then arr, as one sequence of buckets. */
+    size_t bucket_total() const {return (arr == NULL)? 0: old_size + size_;}
+    static size_t table_bytes(size_t n) {
+        return n * sizeof(HashNode<value_type>*) + (n + 63) / 64 * sizeof(unsigned long long);
+    }
+    static unsigned long long* occupancy(HashNode<value_type>** table, size_t n) {
+        return (unsigned long long*)(table + n);
+    }
+    static void set_bit(unsigned long long* bits, size_t i) {bits[i >> 6] |= 1ULL << (i & 63);}
+    static void clear_bit(unsigned long long* bits, size_t i) {bits[i >> 6] &= ~(1ULL << (i & 63));}
+    /* first set bit at or after i, or n */
+    static size_t scan(const unsigned long long* bits, size_t n, size_t i) {
+        if (i >= n) return n;
+        size_t w = i >> 6, words = (n + 63) >> 6;
+        unsigned long long word = bits[w] & (~0ULL << (i & 63));
+        while (word == 0) {
+            if (++w == words) return n;
+            word = bits[w];
+        }
+        return (w << 6) + my::ctz(word);
+    }
+    HashNode<value_type>*& bucket(size_t i) const {return (i < old_size)? old[i]: arr[i - old_size];}
+    size_t next_bucket(size_t i) const {
+        if (arr == NULL) return 0;
+        if (i < old_size) {
+            i = scan(occupancy(old, old_size), old_size, i);
+            if (i < old_size) return i;
+        }
+        return old_size + scan(occupancy(arr, size_), size_, i - old_size);
+    }
+
+    template <class Key>
+    void erase_key(const Key& val) {
+        if (arr == NULL) return;
+        rehash_step();
+        size_t h = hash(val);
+        MY_HASHMAP_COUNT(++counters.finds;)
+        if (old != NULL) {
+            size_t index = h & (old_size - 1);
+            if (index >= migrated && erase_from(old[index], val)) {
+                if (old[index] == NULL) clear_bit(occupancy(old, old_size), index);
+                return;
+            }
+        }
+        size_t index = h & (size_ - 1);
+        if (erase_from(arr[index], val) && arr[index] == NULL)
+            clear_bit(occupancy(arr, size_), index);
+    }
+    template <class Key>
+    value_type* find_key(const Key& val) {
+        if (arr == NULL) return NULL;
+        return find_hashed(val, hash(val));
+    }
+    template <class Key>
+    value_type* find_hashed(const Key& val, size_t h) {
+        MY_HASHMAP_COUNT(++counters.finds;)
+        if (old != NULL) {
+            size_t index = h & (old_size - 1);
+            if (index >= migrated) {
+                value_type* p = find_in(old[index], val);
+                if (p != NULL) return p;
+            }
+        }
+        return find_in(arr[h & (size_ - 1)], val);
+    }
+    template <class Key>
+    void find_many_keys(const Key* keys, size_t n, value_type** out) {
+        if (arr == NULL) {
+            for (size_t i = 0; i < n; ++i) out[i] = NULL;
+            return;
+        }
+        const size_t D = prefetch_distance;
+        size_t h[2 * prefetch_distance];
+        for (size_t i = 0; i < n + 2 * D; ++i) {
+            // the oldest key is finished first, since the newest one reuses its hash slot
+            if (i >= 2 * D) {
+                size_t j = i - 2 * D;
+                out[j] = find_hashed(keys[j], h[j % (2 * D)]);
+            }
+            if (i >= D && i - D < n)
+                my::prefetch(arr[h[(i - D) % (2 * D)] & (size_ - 1)]);
+            if (i < n) {
+                size_t x = h[i % (2 * D)] = hash(keys[i]);
+                my::prefetch(arr + (x & (size_ - 1)));
+                if (old != NULL) my::prefetch(old + (x & (old_size - 1)));
+            }
+        }
+    }
+    template <class Key>
+    V& at_key(const Key& val) {
+        value_type* p = find_key(val);
+        if (p == NULL) throw std::out_of_range("map::at() Key not found!");
+        return p->second;
+    }
+    template <class Key>
+    value_type* find_in(HashNode<value_type>* temp, const Key& val) {
+        while (temp != NULL) {
+            MY_HASHMAP_COUNT(++counters.probes;)
+            if (comp(temp->data.first, val))
+                return &(temp->data);
+            temp = temp->next;
+        }
+        return NULL;
+    }
+    template <class InputIterator>
+    void insert_range(InputIterator first, InputIterator last, std::input_iterator_tag) {
+        for (; first != last; ++first)
+            insert(*first);
+    }
+    template <class ForwardIterator>
+    void insert_range(ForwardIterator first, ForwardIterator last, std::forward_iterator_tag) {
+        size_t n = 0;
+        for (ForwardIterator it = first; it != last; ++it)
+            ++n;
+        reserve(count + n);
+        for (; first != last; ++first)
+            insert(*first);
+    }
+    /* Allocates the table if needed, advances a pending rehash and hashes the key into h.
+     * Returns the existing entry for key, or NULL if the caller should link a new node. */
+    template <class Key>
+    value_type* prepare_insert(const Key& key, size_t& h) {
+        if (arr == NULL) init();
+        rehash_step();
+        h = hash(key);
+        return find_hashed(key, h);
+    }
+    value_type* link_node(HashNode<value_type>* node, size_t h) {
+        if (count + 1 > size_ * max_load)
+            start_rehash(size_ * 2);
+        size_t index = h & (size_ - 1);
+        node->next = arr[index];
+        arr[index] = node;
+        set_bit(occupancy(arr, size_), index);
+        ++count;
+        return &(node->data);
+    }
+    HashNode<value_type>* create_node(const value_type& p) {
+        HashNode<value_type>* node = pool.allocate();
+        new (node) HashNode<value_type>(p);
+        return node;
+    }
+    #if __cplusplus >= 201103L
+    template <class... Args>
+    HashNode<value_type>* create_node(Args&&... args) {
+        HashNode<value_type>* node = pool.allocate();
+        new (node) HashNode<value_type>(std::forward<Args>(args)...);
+        return node;
+    }
+    template <class Key, class... Args>
+    std::pair<value_type*, bool> emplace_key(Key&& key, Args&&... args) {
+        size_t h;
+        value_type* found = prepare_insert(key, h);
+        if (found != NULL)
+            return std::pair<value_type*, bool>(found, false);
+        HashNode<value_type>* node = create_node(std::piecewise_construct,
+            std::forward_as_tuple(std::forward<Key>(key)), std::forward_as_tuple(std::forward<Args>(args)...));
+        return std::pair<value_type*, bool>(link_node(node, h), true);
+    }
+    template <class Key, class M>
+    std::pair<value_type*, bool> assign_key(Key&& key, M&& obj) {
+        size_t h;
+        value_type* found = prepare_insert(key, h);
+        if (found != NULL) {
+            found->second = std::forward<M>(obj);
+            return std::pair<value_type*, bool>(found, false);
+        }
+        HashNode<value_type>* node = create_node(std::forward<Key>(key), std::forward<M>(obj));
+        return std::pair<value_type*, bool>(link_node(node, h), true);
+    }
+    #endif
+    void destroy_node(HashNode<value_type>* node) {
+        node->~HashNode<value_type>();
+        pool.deallocate(node);
+    }
+    template <class Key>
+    bool erase_from(HashNode<value_type>*& head, const Key& val) {
+        HashNode<value_type>** link = &head;
+        while (*link != NULL) {
+            MY_HASHMAP_COUNT(++counters.probes;)
+            if (comp((*link)->data.first, val)) {
+                HashNode<value_type>* temp = *link;
+                *link = temp->next;
+                destroy_node(temp); count--;
+                return true;
+            }
+            link = &((*link)->next);
+        }
+        return false;
+    }
+    void start_rehash(size_t n) {
+        finish_rehash();
+        MY_HASHMAP_COUNT(++counters.rehashes;)
+        old = arr; old_size = size_; migrated = 0;
+        size_ = n;
+        init();
+    }
+    /* Moves up to rehash_batch non-empty buckets from old into arr, so no single operation
+     * pays for the whole table; empty buckets are skipped through the occupancy bitmap. */
+    void rehash_step() {
+        if (old == NULL) return;
+        MY_HASHMAP_COUNT(stat_timer timer(counters.rehash_seconds);)
+        unsigned long long* old_bits = occupancy(old, old_size);
+        unsigned long long* bits = occupancy(arr, size_);
+        for (size_t moved = 0; moved < rehash_batch; ++moved) {
+            migrated = scan(old_bits, old_size, migrated);
+            if (migrated == old_size) break;
+            HashNode<value_type>* temp = old[migrated], *next;
+            while (temp != NULL) {
+                next = temp->next;
+                size_t index = hash(temp->data.first) & (size_ - 1);
+                temp->next = arr[index];
+                arr[index] = temp;
+                set_bit(bits, index);
+                temp = next;
+            }
+            old[migrated] = NULL;
+            clear_bit(old_bits, migrated++);
+        }
+        if (migrated == old_size) {
+            free(old);
+            old = NULL; old_size = 0; migrated = 0;
+        }
+    }
+    void finish_rehash() {
+        while (old != NULL) rehash_step();
+    }
 };
 
 #endif
@@ -0,0 +1,150 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <stdexcept>
+#include <string>
+#include <cstring>
+#include <cerrno>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+/*
+ * A whole file mapped into memory (POSIX). open() maps an existing file, read only by default,
+ * and create() makes a new writable file of the given size. Failures throw std::runtime_error
+ * with the path and the system's reason. The mapping is released by close() or the destructor.
+ */
+
+namespace my {
+    class mapped_file;
+}
+class my::mapped_file {
+    public:
+    enum mode {read_only, read_write};
+
+    mapped_file(): fd(-1), addr(NULL), len(0), writable(false) {}
+    explicit mapped_file(const char* path, mode m = read_only): fd(-1), addr(NULL), len(0), writable(false) {
+        open(path, m);
+    }
+    ~mapped_file() {close();}
+
+    #if __cplusplus >= 201103L
+    mapped_file(mapped_file&& o) noexcept: fd(o.fd), addr(o.addr), len(o.len), writable(o.writable) {
+        o.fd = -1; o.addr = NULL; o.len = 0;
+    }
+    mapped_file& operator=(mapped_file&& o) noexcept {
+        if (this != &o) {
+            close();
+            fd = o.fd; addr = o.addr; len = o.len; writable = o.writable;
+            o.fd = -1; o.addr = NULL; o.len = 0;
+        }
+        return *this;
+    }
+    #endif
+
+    void open(const char* path, mode m = read_only) {
+        close();
+        writable = (m == read_write);
+        fd = ::open(path, writable? O_RDWR: O_RDONLY);
+        if (fd < 0) fail("open", path);
+        struct stat st;
+        if (fstat(fd, &st) != 0) fail("stat", path);
+        map_fd((size_t)st.st_size, path);
+    }
+    /* creates (or truncates) path and maps size zero-filled bytes of it for writing */
+    void create(const char* path, size_t size) {
+        close();
+        writable = true;
+        fd = ::open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) fail("create", path);
+        if (ftruncate(fd, (off_t)size) != 0) fail("resize", path);
+        map_fd(size, path);
+    }
+    /* Grows or shrinks a writable file; the mapping may move, so pointers into it become stale.
+     * The file is grown before the mapping and shrunk after it, so the mapping never reaches past
+     * the end of the file, where a touch would raise SIGBUS. If remapping fails the old mapping is
+     * kept; if only the final truncation of a shrink fails, the mapping is already the new size. */
+    void resize(size_t size) {
+        if (!writable) throw std::logic_error("mapped_file::resize() file is read only");
+        size_t old = len;
+        if (size > old && ftruncate(fd, (off_t)size) != 0) error("resize", "mapped file");
+        if (old == 0 || size == 0) {
+            unmap();
+            map_fd(size, "mapped file");
+        }
+        else if (size != old) {
+        #ifdef MREMAP_MAYMOVE
+            void* p = mremap(addr, len, size, MREMAP_MAYMOVE);
+            if (p == MAP_FAILED) error("remap", "mapped file");
+            addr = p; len = size;
+        #else
+            unmap();
+            map_fd(size, "mapped file");
+        #endif
+        }
+        if (size < old && ftruncate(fd, (off_t)size) != 0) error("resize", "mapped file");
+    }
+    /* writes dirty pages back to the file */
+    void sync() {
+        if (addr != NULL && writable && msync(addr, len, MS_SYNC) != 0)
+            error("sync", "mapped file");
+    }
+    /* passes an access pattern hint (MADV_SEQUENTIAL, MADV_WILLNEED, ...) to the kernel */
+    void advise(int advice) {
+        if (addr != NULL) madvise(addr, len, advice);
+    }
+    /* the same for bytes [offset, offset + length) only, widened to whole pages */
+    void advise(int advice, size_t offset, size_t length) {
+        if (addr == NULL || offset >= len) return;
+        if (length > len - offset) length = len - offset;
+        size_t start = offset - offset % (size_t)sysconf(_SC_PAGESIZE);
+        madvise((char*)addr + start, offset + length - start, advice);
+    }
+    void close() {
+        unmap();
+        if (fd >= 0) ::close(fd);
+        fd = -1;
+    }
+
+    bool is_open() const {return fd >= 0;}
+    size_t size() const {return len;}
+    char* data() {return (char*)addr;}
+    const char* data() const {return (const char*)addr;}
+
+    private:
+    int fd;
+    void* addr;
+    size_t len;
+    bool writable;
+
+    mapped_file(const mapped_file&);
+    mapped_file& operator=(const mapped_file&);
+
+    void map_fd(size_t size, const char* path) {
+        len = size;
+        if (size == 0) return;  // mmap rejects empty mappings
+        addr = mmap(NULL, size, writable? PROT_READ | PROT_WRITE: PROT_READ, MAP_SHARED, fd, 0);
+        if (addr == MAP_FAILED) {
+            addr = NULL; len = 0;
+            fail("map", path);
+        }
+    }
+    void unmap() {
+        if (addr != NULL) munmap(addr, len);
+        addr = NULL; len = 0;
+    }
+    /* throws, leaving the file open and mapped */
+    void error(const char* what, const char* path) {
+        throw std::runtime_error(std::string("mapped_file: cannot ") + what + " " + path + ": " + strerror(errno));
+    }
+    /* closes the file, then throws */
+    void fail(const char* what, const char* path) {
+        std::string msg = std::string("mapped_file: cannot ") + what + " " + path + ": " + strerror(errno);
+        close();
+        throw std::runtime_error(msg);
+    }
+};
+
+#endif
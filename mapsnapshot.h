@@ -0,0 +1,201 @@
+#ifndef MAPSNAPSHOT_H
+#define MAPSNAPSHOT_H
+
+#include <stdexcept>
+#include <string>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "hashmap.h"
+#include "mappedfile.h"
+
+/*
+ * A read-only snapshot of a my::map that can be written to a file and mapped back in place.
+ * save() writes the map's entries in one flat block; a snapshot constructed from the file
+ * mmaps it and answers find() directly from the mapped pages, with no parsing or inserting.
+ * The file holds no pointers, only indices, so it works at any address:
+ *
+ *     header | bucket offsets (buckets + 1 of them) | entries grouped by bucket
+ *
+ * Bucket b holds entries [offset[b], offset[b + 1]). K and V must be trivially copyable, and H must
+ * give the same value in the loading process as in the saving one (my::hash does).
+ */
+
+namespace my {
+    template <class K, class V, class C = my::equals<K>, class H = hash> class map_snapshot;
+}
+template <class K, class V, class C, class H>
+class my::map_snapshot {
+    #if __cplusplus >= 201103L
+    static_assert(std::is_trivially_copyable<K>::value && std::is_trivially_copyable<V>::value,
+                  "map_snapshot keys and values must be trivially copyable");
+    #endif
+    public:
+    /* a stored entry; unlike std::pair it is trivially copyable */
+    struct value_type {
+        K first;
+        V second;
+    };
+    typedef const value_type* const_iterator;
+    typedef size_t size_type;
+
+    map_snapshot(const C& compfunc = C(), const H& hashfunc = H()): hdr(NULL), offsets(NULL), entries(NULL), hash(hashfunc), comp(compfunc) {}
+    explicit map_snapshot(const char* path, const C& compfunc = C(), const H& hashfunc = H()): hdr(NULL), offsets(NULL), entries(NULL), hash(hashfunc), comp(compfunc) {
+        open(path);
+    }
+
+    /* maps path and checks that it is a snapshot of this K and V; throws std::runtime_error if not */
+    void open(const char* path) {
+        close();
+        file.open(path);
+        const char* base = file.data();
+        if (file.size() < sizeof(header))
+            bad(path, "file too short");
+        const header* h = (const header*)base;
+        if (memcmp(h->magic, magic(), sizeof(h->magic)) != 0)
+            bad(path, "not a map snapshot");
+        if (h->version != format_version || h->key_size != sizeof(K) || h->value_size != sizeof(V)
+            || h->entry_size != sizeof(value_type))
+            bad(path, "written for a different format or key/value type");
+        // sizes are checked by division, so a hostile header cannot overflow them
+        if (h->buckets == 0 || (h->buckets & (h->buckets - 1)) != 0
+            || h->buckets >= (file.size() - sizeof(header)) / sizeof(unsigned long long)
+            || h->entries_at != entries_offset(h->buckets) || h->entries_at > file.size()
+            || h->count > (file.size() - h->entries_at) / sizeof(value_type))
+            bad(path, "truncated or corrupt");
+        hdr = h;
+        offsets = (const unsigned long long*)(base + sizeof(header));
+        entries = (const value_type*)(base + h->entries_at);
+        // find() trusts every offset, so check them all once here
+        if (offsets[0] != 0 || offsets[hdr->buckets] != hdr->count)
+            bad(path, "truncated or corrupt");
+        for (unsigned long long b = 0; b < hdr->buckets; ++b)
+            if (offsets[b] > offsets[b + 1])
+                bad(path, "truncated or corrupt");
+        file.advise(MADV_RANDOM);
+    }
+    void close() {
+        file.close();
+        hdr = NULL; offsets = NULL; entries = NULL;
+    }
+    bool is_open() const {return hdr != NULL;}
+
+    const value_type* find(const K& val) const {
+        if (hdr == NULL) return NULL;
+        size_t b = hash(val) & (size_t)(hdr->buckets - 1);
+        for (const value_type* p = entries + offsets[b], *e = entries + offsets[b + 1]; p != e; ++p)
+            if (comp(p->first, val))
+                return p;
+        return NULL;
+    }
+    const V& at(const K& val) const {
+        const value_type* p = find(val);
+        if (p == NULL) throw std::out_of_range("map_snapshot::at() Key not found!");
+        return p->second;
+    }
+    size_t size() const {return (hdr == NULL)? 0: (size_t)hdr->count;}
+    bool empty() const {return size() == 0;}
+
+    const_iterator begin() const {return entries;}
+    const_iterator end() const {return entries + size();}
+
+    /* Copies every entry into a fresh my::map, for when the table must be modified after loading. */
+    template <class A>
+    void load_into(my::map<K, V, C, H, A>& m) const {
+        m.reserve(m.size() + size());
+        for (const_iterator it = begin(); it != end(); ++it)
+            m.insert(std::pair<const K, V>(it->first, it->second));
+    }
+
+    /* Writes m to path. The file is built under a temporary name and renamed into place, so a
+     * process loading path sees either the old snapshot or the complete new one, and on failure the
+     * temporary file is removed. */
+    template <class A>
+    static void save(my::map<K, V, C, H, A>& m, const char* path, const H& hashfunc = H()) {
+        unsigned long long n = m.size(), buckets = next_pow2(m.size() / 2 + 1);
+        std::vector<size_t> hashes;
+        hashes.reserve((size_t)n);
+        std::string tmp = std::string(path) + ".tmp";
+        mapped_file out;
+        try {
+            out.create(tmp.c_str(), (size_t)(entries_offset(buckets) + n * sizeof(value_type)));
+            char* base = out.data();
+            header* h = (header*)base;
+            memcpy(h->magic, magic(), sizeof(h->magic));
+            h->version = format_version;
+            h->key_size = sizeof(K);
+            h->value_size = sizeof(V);
+            h->entry_size = sizeof(value_type);
+            h->count = n;
+            h->buckets = buckets;
+            h->entries_at = entries_offset(buckets);
+
+            // counting sort by bucket: count, prefix sum, then place each entry
+            unsigned long long* off = (unsigned long long*)(base + sizeof(header));
+            typename my::map<K, V, C, H, A>::iterator it;
+            for (it = m.begin(); it != m.end(); ++it) {
+                hashes.push_back(hashfunc(it->first) & (size_t)(buckets - 1));
+                ++off[hashes.back() + 1];
+            }
+            for (unsigned long long b = 0; b < buckets; ++b)
+                off[b + 1] += off[b];
+            std::vector<unsigned long long> next(off, off + buckets);
+            value_type* e = (value_type*)(base + h->entries_at);
+            size_t i = 0;
+            for (it = m.begin(); it != m.end(); ++it, ++i) {
+                value_type* slot = e + next[hashes[i]]++;
+                memcpy(&slot->first, &it->first, sizeof(K));
+                memcpy(&slot->second, &it->second, sizeof(V));
+            }
+            out.sync();
+            out.close();
+        }
+        catch (...) {
+            // don't leave a partly written snapshot behind
+            out.close();
+            std::remove(tmp.c_str());
+            throw;
+        }
+        if (std::rename(tmp.c_str(), path) != 0) {
+            std::string msg = std::string("map_snapshot: cannot rename ") + tmp + " to " + path + ": " + strerror(errno);
+            std::remove(tmp.c_str());
+            throw std::runtime_error(msg);
+        }
+    }
+
+    private:
+    static const unsigned format_version = 1;
+    struct header {
+        char magic[8];
+        unsigned version;
+        unsigned key_size;
+        unsigned value_size;
+        unsigned entry_size;
+        unsigned long long count;
+        unsigned long long buckets;
+        unsigned long long entries_at;  // byte offset of the first entry
+        char reserved[16];
+    };
+    mapped_file file;
+    const header* hdr;
+    const unsigned long long* offsets;
+    const value_type* entries;
+    H hash;
+    C comp;
+
+    map_snapshot(const map_snapshot&);
+    map_snapshot& operator=(const map_snapshot&);
+
+    static const char* magic() {return "MYMAPSN";}
+    /* the entry block starts after the offsets, rounded up to a multiple of 64 bytes */
+    static unsigned long long entries_offset(unsigned long long buckets) {
+        unsigned long long end = sizeof(header) + (buckets + 1) * sizeof(unsigned long long);
+        return (end + 63) & ~63ULL;
+    }
+    void bad(const char* path, const char* why) {
+        close();
+        throw std::runtime_error(std::string("map_snapshot: ") + path + ": " + why);
+    }
+};
+
+#endif
@@ -0,0 +1,388 @@
+#ifndef MMAPVECTOR_H
+#define MMAPVECTOR_H
+
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <new>
+#include <unistd.h>
+#include "utilities.h"
+#include "vectorbase.h"
+#include "vector.h"
+#include "mappedfile.h"
+
+/*
+ * A my::vector whose elements live in a memory-mapped file (POSIX), for arrays larger than RAM
+ * or that should outlive the process. The file is a small header followed by the elements as
+ * they are in memory, so reopening it maps them back with nothing to parse:
+ *
+ *     header (64 bytes) | element 0 | element 1 | ...
+ *
+ * Growing extends the file with ftruncate and the mapping with mremap. Capacity grows by
+ * vector_growth<T> as in my::vector; the unused tail is a hole in the file and takes no disk
+ * space, and close() cuts the file back to the elements. The header's count is kept current, so
+ * the elements survive a crash of the process, though not of the machine unless sync() was called.
+ * The kernel pages elements in and out as needed; advise(MADV_SEQUENTIAL) before a scan lets it
+ * read ahead and drop pages behind the scan.
+ *
+ *     my::mmap_vector<double> v("samples.bin");   // opens the file, or creates it
+ *     v.push_back(1.5);
+ *
+ * T must be trivially copyable and is stored with this machine's byte order and layout. As in
+ * my::vector, growing may move the mapping and invalidate iterators. A vector opened read_only
+ * throws std::logic_error from anything that would change it; file errors throw std::runtime_error.
+ * Its elements are mapped read only too, so read them through a const mmap_vector& or
+ * const_iterators: storing through a T& or iterator into a read_only vector faults instead of throwing.
+ * Every change must also write the header's count, so this is not a my::vector_base; it shares
+ * the iterators, growth and search helpers of vectorbase.h.
+ */
+
+namespace my {
+    template <class T> class mmap_vector;
+}
+template <class T>
+class my::mmap_vector {
+    #if __cplusplus >= 201103L
+    static_assert(std::is_trivially_copyable<T>::value, "mmap_vector elements must be trivially copyable");
+    #endif
+    public:
+    typedef size_t size_type;
+    typedef T value_type;
+    typedef vector_iterator<T, T> iterator;
+    typedef vector_iterator<T, const T> const_iterator;
+    typedef std::reverse_iterator<iterator> reverse_iterator;
+    typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+    typedef mapped_file::mode mode;
+
+    mmap_vector(): hdr(NULL), arr(NULL), inUse(0), allocated(0), writable(false) {}
+    explicit mmap_vector(const char* path, mode m = mapped_file::read_write): hdr(NULL), arr(NULL), inUse(0), allocated(0), writable(false) {
+        open(path, m);
+    }
+    ~mmap_vector() {
+        try {close();}
+        catch (...) {}
+    }
+    #if __cplusplus >= 201103L
+    mmap_vector(mmap_vector&& v): file(std::move(v.file)), hdr(v.hdr), arr(v.arr), inUse(v.inUse), allocated(v.allocated), writable(v.writable) {
+        v.hdr = NULL; v.arr = NULL; v.inUse = 0; v.allocated = 0; v.writable = false;
+    }
+    mmap_vector& operator=(mmap_vector&& v) {
+        if (this != &v) {
+            close();
+            file = std::move(v.file);
+            hdr = v.hdr; arr = v.arr; inUse = v.inUse; allocated = v.allocated; writable = v.writable;
+            v.hdr = NULL; v.arr = NULL; v.inUse = 0; v.allocated = 0; v.writable = false;
+        }
+        return *this;
+    }
+    void swap(mmap_vector& v) {
+        mmap_vector temp(std::move(v));
+        v = std::move(*this);
+        *this = std::move(temp);
+    }
+    #endif
+
+    /* Maps path and checks that it holds T's. With read_write a missing file is created empty. */
+    void open(const char* path, mode m = mapped_file::read_write);
+    /* makes path a new empty vector, replacing any file there */
+    void create(const char* path);
+    /* cuts the file back to the elements and unmaps it */
+    void close();
+    /* writes the elements and the count to disk */
+    void sync() {if (writable) file.sync();}
+    /* madvise hints for the whole file or for the pages holding [begin, end) */
+    void advise(int advice) {file.advise(advice);}
+    void advise(int advice, const_iterator begin, const_iterator end) {
+        file.advise(advice, sizeof(header) + (begin.base() - arr) * sizeof(T), (end - begin) * sizeof(T));
+    }
+    bool is_open() const {return hdr != NULL;}
+
+    /* operator[], front() and back() check only under MY_VECTOR_HARDENED, as in my::vector */
+    T& at(size_t val) {check_index(val); return arr[val];}
+    const T& at(size_t val) const {check_index(val); return arr[val];}
+    T& operator[](size_t val) {MY_VECTOR_CHECK(check_index(val);) return arr[val];}
+    const T& operator[](size_t val) const {MY_VECTOR_CHECK(check_index(val);) return arr[val];}
+    T& front() {MY_VECTOR_CHECK(check_nonempty("front");) return arr[0];}
+    const T& front() const {MY_VECTOR_CHECK(check_nonempty("front");) return arr[0];}
+    T& back() {MY_VECTOR_CHECK(check_nonempty("back");) return arr[inUse-1];}
+    const T& back() const {MY_VECTOR_CHECK(check_nonempty("back");) return arr[inUse-1];}
+    T* data() {return arr;}
+    const T* data() const {return arr;}
+    void push_back(const T& val);
+    /* always checked: an underflowed count would be written to the file */
+    void pop_back() {check_writable(); check_nonempty("pop_back"); set_size(inUse-1);}
+    template<class InputIterator>
+    void copy(InputIterator begin, InputIterator end) {
+        for (; begin != end; ++begin)
+            push_back(*begin);
+    }
+    iterator insert(iterator it, const T& val, size_t n = 1);
+    template<class InputIterator>
+    void insert(iterator it, InputIterator begin, InputIterator end);
+    void erase(iterator it) {erase(it, it+1);}
+    void erase(iterator begin, iterator end);
+    void eraseAll(const T& val);
+    template <class Predicate>
+    void eraseIf(Predicate pred);
+    bool empty() const {return inUse == 0;}
+    size_t size() const {return inUse;}
+    size_t capacity() const {return allocated;}
+    void resize(size_t v, const T& val);
+    void resize(size_t v) {resize(v, T());}
+    void reserve(size_t v) {if (v > allocated) remap(v);}
+    void shrink_to_fit() {if (inUse < allocated) remap(inUse);}
+    /* keeps the capacity, as my::vector does */
+    void clear() {check_writable(); set_size(0);}
+    void sort() {check_writable(); my::sort(arr, arr+inUse);}
+    template <class C>
+    void sort(C compare) {check_writable(); my::sort(arr, arr+inUse, compare);}
+    iterator find(iterator begin, iterator end, const T& val) const {return iterator(my::find(begin.base(), end.base(), val));}
+    const_iterator find(const_iterator begin, const_iterator end, const T& val) const
+    {return const_iterator(my::find(begin.base(), end.base(), val));}
+    size_t count(const_iterator begin, const_iterator end, const T& val) const {return my::count(begin.base(), end.base(), val);}
+    //uses binary search
+    iterator find_s(iterator begin, iterator end, const T& val) const
+    {return iterator(detail::find_sorted(begin.base(), end.base(), val));}
+    const_iterator find_s(const_iterator begin, const_iterator end, const T& val) const
+    {return const_iterator(detail::find_sorted(begin.base(), end.base(), val));}
+    iterator begin() {return iterator(arr);}
+    iterator end() {return iterator(arr+inUse);}
+    const_iterator begin() const {return const_iterator(arr);}
+    const_iterator end() const {return const_iterator(arr+inUse);}
+    const_iterator cbegin() const {return const_iterator(arr);}
+    const_iterator cend() const {return const_iterator(arr+inUse);}
+    reverse_iterator rbegin() {return reverse_iterator(end());}
+    reverse_iterator rend() {return reverse_iterator(begin());}
+    const_reverse_iterator rbegin() const {return const_reverse_iterator(end());}
+    const_reverse_iterator rend() const {return const_reverse_iterator(begin());}
+    const_reverse_iterator crbegin() const
+    {return const_reverse_iterator(cend());}
+    const_reverse_iterator crend() const
+    {return const_reverse_iterator(cbegin());}
+
+    #if __cplusplus >= 201103L
+    void insert(iterator it, std::initializer_list<T> l) {insert(it, l.begin(), l.end());}
+    template <class... Args>
+    iterator emplace(iterator it, Args&&... args)
+    {return insert(it, T(std::forward<Args>(args)...));}
+    template <class... Args>
+    void emplace_back(Args&&... args) {push_back(T(std::forward<Args>(args)...));}
+    #endif
+
+    private:
+    static const unsigned format_version = 1;
+    struct header {
+        char magic[8];
+        unsigned version;
+        unsigned elem_size;
+        unsigned long long count;
+        char reserved[40];  // keeps the elements 64 byte aligned
+    };
+    mapped_file file;
+    header* hdr;
+    T* arr;
+    size_t inUse;
+    size_t allocated;
+    bool writable;
+
+    mmap_vector(const mmap_vector&);
+    mmap_vector& operator=(const mmap_vector&);
+
+    static const char* magic() {return "MYMMVEC";}
+    void check_index(size_t val) const {if (val >= inUse) detail::vector_range_error("mmap_vector", val, inUse);}
+    void check_nonempty(const char* caller) const {if (inUse == 0) detail::vector_empty_error("mmap_vector", caller);}
+    void check_writable() const {
+        if (!writable) throw std::logic_error("mmap_vector: not open for writing");
+    }
+    void set_size(size_t n) {inUse = n; hdr->count = n;}
+    void attach();
+    void remap(size_t n);
+    /* grows by vector_growth<T> like my::vector, but never by less than a page of elements */
+    size_t next_capacity(size_t needed) const {
+        return detail::next_capacity<T>(allocated, needed, (size_t)sysconf(_SC_PAGESIZE) / sizeof(T));
+    }
+    void open_gap(size_t pos, size_t n);
+    template<class InputIterator>
+    void insert(iterator it, InputIterator begin, InputIterator end, bool_constant<false>);
+    template<class Integer>
+    void insert(iterator it, Integer val, Integer n, bool_constant<true>) {insert(it, (T)val, (size_t)n);}
+    template<class InputIterator>
+    void insert_range(size_t pos, InputIterator begin, InputIterator end, std::input_iterator_tag);
+    template<class ForwardIterator>
+    void insert_range(size_t pos, ForwardIterator begin, ForwardIterator end, std::forward_iterator_tag);
+    void bad(const char* path, const char* why) {
+        close();
+        throw std::runtime_error(std::string("mmap_vector: ") + path + ": " + why);
+    }
+};
+
+template <class T>
+void my::mmap_vector<T>::open(const char* path, mode m) {
+    close();
+    if (m == mapped_file::read_write && access(path, F_OK) != 0) {
+        create(path);
+        return;
+    }
+    file.open(path, m);
+    writable = (m == mapped_file::read_write);
+    if (file.size() < sizeof(header))
+        bad(path, "file too short");
+    const header* h = (const header*)file.data();
+    if (memcmp(h->magic, magic(), sizeof(h->magic)) != 0)
+        bad(path, "not an mmap_vector");
+    if (h->version != format_version || h->elem_size != sizeof(T))
+        bad(path, "written for a different format or element type");
+    if ((file.size() - sizeof(header)) / sizeof(T) < h->count)
+        bad(path, "truncated or corrupt");
+    attach();
+    inUse = (size_t)h->count;
+}
+template <class T>
+void my::mmap_vector<T>::create(const char* path) {
+    close();
+    file.create(path, sizeof(header));
+    writable = true;
+    header* h = (header*)file.data();
+    memcpy(h->magic, magic(), sizeof(h->magic));
+    h->version = format_version;
+    h->elem_size = sizeof(T);
+    h->count = 0;
+    attach();
+    inUse = 0;
+}
+template <class T>
+void my::mmap_vector<T>::close() {
+    if (hdr != NULL && writable && allocated > inUse)
+        file.resize(sizeof(header) + inUse * sizeof(T));
+    file.close();
+    hdr = NULL; arr = NULL;
+    inUse = 0; allocated = 0;
+    writable = false;
+}
+/* points hdr and arr into the current mapping */
+template <class T>
+void my::mmap_vector<T>::attach() {
+    hdr = (header*)file.data();
+    arr = (T*)(file.data() + sizeof(header));
+    allocated = (file.size() - sizeof(header)) / sizeof(T);
+}
+/* Resizes the file to n elements. mremap moves the pages rather than copying them, so growing
+ * costs the same however many elements there are. */
+template <class T>
+void my::mmap_vector<T>::remap(size_t n) {
+    check_writable();
+    if (n > ((size_t)-1 - sizeof(header)) / sizeof(T)) throw std::length_error("mmap_vector: too many elements");
+    try {
+        file.resize(sizeof(header) + n * sizeof(T));
+    }
+    catch (...) {
+        // a failed resize leaves a valid mapping, old or already shrunk, unless it had been dropped
+        if (file.data() == NULL) {
+            hdr = NULL; arr = NULL;
+            inUse = 0; allocated = 0;
+            writable = false;
+        }
+        else
+            attach();
+        throw;
+    }
+    attach();
+}
+template <class T>
+void my::mmap_vector<T>::push_back(const T& val) {
+    check_writable();
+    if (inUse == allocated) {
+        T temp(val);  // val may live in arr
+        remap(next_capacity(inUse+1));
+        new (arr+inUse) T(temp);
+    }
+    else
+        new (arr+inUse) T(val);
+    set_size(inUse+1);
+}
+template <class T>
+void my::mmap_vector<T>::resize(size_t v, const T& val) {
+    check_writable();
+    if (v > allocated) {
+        T temp(val);  // val may live in arr
+        remap(next_capacity(v));
+        for (size_t i = inUse; i < v; i++)
+            new (arr+i) T(temp);
+    }
+    else {
+        for (size_t i = inUse; i < v; i++)
+            new (arr+i) T(val);
+    }
+    set_size(v);
+}
+/* the elements from pos on move n slots up in one memmove, leaving [pos, pos+n) to be filled */
+template <class T>
+void my::mmap_vector<T>::open_gap(size_t pos, size_t n) {
+    check_writable();
+    if (inUse + n > allocated)
+        remap(next_capacity(inUse+n));
+    memmove((void*)(arr+pos+n), (const void*)(arr+pos), sizeof(T)*(inUse-pos));
+}
+template <class T>
+typename my::mmap_vector<T>::iterator my::mmap_vector<T>::insert(iterator it, const T& val, size_t n) {
+    size_t pos = it.base() - arr;
+    if (n == 0) return it;
+    T temp(val);  // val may live in arr
+    open_gap(pos, n);
+    for (size_t i = pos; i < pos+n; i++)
+        new (arr+i) T(temp);
+    set_size(inUse+n);
+    return iterator(arr+pos);
+}
+template <class T> template<class InputIterator>
+void my::mmap_vector<T>::insert(iterator it, InputIterator begin, InputIterator end) {
+    insert(it, begin, end, bool_constant<is_integer<InputIterator>::value>());
+}
+template <class T> template<class InputIterator>
+void my::mmap_vector<T>::insert(iterator it, InputIterator begin, InputIterator end, bool_constant<false>) {
+    insert_range(it.base() - arr, begin, end, typename std::iterator_traits<InputIterator>::iterator_category());
+}
+/* as in my::vector: a single pass range is appended and rotated into place */
+template <class T> template<class InputIterator>
+void my::mmap_vector<T>::insert_range(size_t pos, InputIterator begin, InputIterator end, std::input_iterator_tag) {
+    size_t old = inUse;
+    for (; begin != end; ++begin)
+        push_back(*begin);
+    std::rotate(arr+pos, arr+old, arr+inUse);
+}
+template <class T> template<class ForwardIterator>
+void my::mmap_vector<T>::insert_range(size_t pos, ForwardIterator begin, ForwardIterator end, std::forward_iterator_tag) {
+    size_t n = my::distance(begin, end, typename std::iterator_traits<ForwardIterator>::iterator_category());
+    if (n == 0) return;
+    open_gap(pos, n);
+    for (size_t i = pos; i < pos+n; i++, ++begin)
+        new (arr+i) T(*begin);
+    set_size(inUse+n);
+}
+template <class T>
+void my::mmap_vector<T>::erase(iterator begin, iterator end) {
+    size_t n = end - begin, pos = begin.base() - arr;
+    if (n == 0)
+        return;
+    check_writable();
+    memmove((void*)(arr+pos), (const void*)(arr+pos+n), sizeof(T)*(inUse-pos-n));
+    set_size(inUse-n);
+}
+template <class T>
+void my::mmap_vector<T>::eraseAll(const T& val) {
+    check_writable();
+    T temp(val);  // val may live in arr
+    set_size(my::remove(arr, arr+inUse, temp) - arr);
+}
+template <class T> template <class Predicate>
+void my::mmap_vector<T>::eraseIf(Predicate pred) {
+    check_writable();
+    set_size(detail::remove_if(arr, arr+inUse, pred) - arr);
+}
+
+#endif
@@ -0,0 +1,199 @@
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include "utilities.h"
+
+/*
+ * Searches over sorted data that take no data dependent branches.
+ *
+ * my::lower_bound(first, last, val[, comp]) returns the first element of the sorted range that is
+ * not less than val, or last. Each step halves the range with a conditional move instead of a
+ * branch, so there is nothing to mispredict, and prefetches both places the next step may look,
+ * so a search over a large array waits for memory about once per step instead of once per load.
+ *
+ * my::eytzinger_index<T> is a read-only copy of a sorted array laid out as an implicit binary
+ * search tree, in breadth first order: the children of element k are 2k and 2k + 1. The top of
+ * the tree, which every search visits, packs into a few cache lines. The array starts on a cache
+ * line boundary, so the 16 (for 4 byte T) descendants of k four levels down, 16k to 16k + 15,
+ * fill one line, which is prefetched while the search walks to it.
+ */
+
+namespace my {
+    template <class T, class A> class vector;
+    template <class T, class C = my::less<T> > class eytzinger_index;
+
+    template <class T, class Compare>
+    const T* lower_bound(const T* first, const T* last, const T& val, Compare comp) {
+        size_t n = last - first;
+        if (n == 0) return first;
+        // the answer is always in [first, first + n]
+        while (n > 1) {
+            size_t half = n / 2;
+            my::prefetch(first + half / 2);
+            my::prefetch(first + half + half / 2);
+            // arithmetic rather than ?: so the compiler cannot turn it back into a branch
+            first += half * (size_t)comp(first[half], val);
+            n -= half;
+        }
+        return first + comp(*first, val);
+    }
+    template <class T>
+    const T* lower_bound(const T* first, const T* last, const T& val) {
+        return my::lower_bound(first, last, val, my::less<T>());
+    }
+    template <class T, class Compare>
+    T* lower_bound(T* first, T* last, const T& val, Compare comp) {
+        return const_cast<T*>(my::lower_bound((const T*)first, (const T*)last, val, comp));
+    }
+    template <class T>
+    T* lower_bound(T* first, T* last, const T& val) {
+        return const_cast<T*>(my::lower_bound((const T*)first, (const T*)last, val, my::less<T>()));
+    }
+}
+
+template <class T, class C>
+class my::eytzinger_index {
+    public:
+    typedef T value_type;
+    typedef size_t size_type;
+
+    explicit eytzinger_index(const C& compfunc = C()): tree(NULL), block(NULL), n(0), comp(compfunc) {}
+    /* [first, last) must be sorted by comp */
+    eytzinger_index(const T* first, const T* last, const C& compfunc = C()): tree(NULL), block(NULL), n(0), comp(compfunc) {
+        build(first, last - first);
+    }
+    template <class A>
+    explicit eytzinger_index(const my::vector<T, A>& sorted, const C& compfunc = C()): tree(NULL), block(NULL), n(0), comp(compfunc) {
+        build(sorted.data(), sorted.size());
+    }
+    eytzinger_index(const eytzinger_index& e): tree(NULL), block(NULL), n(0), comp(e.comp) {
+        copy_from(e);
+    }
+    eytzinger_index& operator=(const eytzinger_index& e) {
+        if (this != &e) {
+            release();
+            comp = e.comp;
+            copy_from(e);
+        }
+        return *this;
+    }
+    #if __cplusplus >= 201103L
+    eytzinger_index(eytzinger_index&& e): tree(e.tree), block(e.block), n(e.n), comp(e.comp) {
+        e.tree = NULL; e.block = NULL; e.n = 0;
+    }
+    eytzinger_index& operator=(eytzinger_index&& e) {
+        if (this != &e) {
+            release();
+            tree = e.tree; block = e.block; n = e.n; comp = e.comp;
+            e.tree = NULL; e.block = NULL; e.n = 0;
+        }
+        return *this;
+    }
+    #endif
+    ~eytzinger_index() {release();}
+
+    size_t size() const {return n;}
+    bool empty() const {return n == 0;}
+
+    /* the smallest element not less than val, or NULL if every element is less */
+    const T* lower_bound(const T& val) const {
+        size_t k = search(val);
+        return (k == 0)? NULL: tree + k;
+    }
+    /* the element equal to val, or NULL */
+    const T* find(const T& val) const {
+        const T* p = lower_bound(val);
+        return (p != NULL && !comp(val, *p))? p: NULL;
+    }
+    bool contains(const T& val) const {return find(val) != NULL;}
+
+    private:
+    T* tree;  // 1 based: tree[1] is the root, tree[0] is unused
+    void* block;
+    size_t n;
+    C comp;
+
+    enum {cache_line = 64};
+    /* tree + k*prefetch_stride() is the line holding k's descendants four levels down when T is a
+     * power of two bytes long; for other sizes the prefetch is merely early. */
+    static size_t prefetch_stride() {return (sizeof(T) >= cache_line)? 16: cache_line / sizeof(T);}
+
+    size_t search(const T& val) const {
+        size_t k = 1;
+        while (k <= n) {
+            my::prefetch(tree + k * prefetch_stride());
+            k = 2 * k + comp(tree[k], val);
+        }
+        // the path went right every time after the last left turn; undo those and that turn
+        return k >> (ctz(~(unsigned long long)k) + 1);
+    }
+    void allocate(size_t count) {
+        // tree[0] starts a cache line, so the descendants 16k..16k+15 of node k share one
+        block = malloc(sizeof(T) * (count + 1) + cache_line);
+        if (block == NULL) throw std::bad_alloc();
+        char* base = (char*)block;
+        base += (cache_line - (size_t)base % cache_line) % cache_line;
+        tree = (T*)base;
+    }
+    void build(const T* sorted, size_t count) {
+        allocate(count);
+        n = count;
+        size_t built = 0;
+        try {
+            fill(sorted, 0, 1, built);
+        }
+        catch (...) {
+            unfill(1, built);
+            free(block);
+            tree = NULL; block = NULL; n = 0;
+            throw;
+        }
+    }
+    /* in order traversal of the implicit tree assigns the sorted elements in order */
+    size_t fill(const T* sorted, size_t i, size_t k, size_t& built) {
+        if (k <= n) {
+            i = fill(sorted, i, 2 * k, built);
+            new (tree + k) T(sorted[i++]);
+            ++built;
+            i = fill(sorted, i, 2 * k + 1, built);
+        }
+        return i;
+    }
+    void copy_from(const eytzinger_index& e) {
+        if (e.n == 0) return;
+        allocate(e.n);
+        n = e.n;
+        size_t k = 1;
+        try {
+            for (; k <= n; ++k)
+                new (tree + k) T(e.tree[k]);
+        }
+        catch (...) {
+            for (size_t i = 1; i < k; ++i)
+                tree[i].~T();
+            free(block);
+            tree = NULL; block = NULL; n = 0;
+            throw;
+        }
+    }
+    /* destroys the first left nodes in the order fill() constructed them */
+    void unfill(size_t k, size_t& left) {
+        if (k > n || left == 0) return;
+        unfill(2 * k, left);
+        if (left == 0) return;
+        tree[k].~T();
+        --left;
+        unfill(2 * k + 1, left);
+    }
+    void release() {
+        for (size_t k = 1; k <= n; ++k)
+            tree[k].~T();
+        free(block);
+        tree = NULL; block = NULL; n = 0;
+    }
+};
+
+#endif
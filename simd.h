@@ -0,0 +1,340 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+#include <cstddef>
+#include <cstring>
+#include "utilities.h"
+
+#if !defined(MY_NO_SIMD) && (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__)))
+#define MY_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+/*
+ * my::find, my::count and my::remove over [first, last) by equality with val. For integer, float
+ * and double elements on x86 they compare a whole vector register of elements per instruction:
+ * with AVX2 if the processor has it, checked once at run time, otherwise with SSE2, which every
+ * x86-64 processor has. Any other T, or other processors, or MY_NO_SIMD, gets the plain loop.
+ * Floats compare as with ==, so NaN matches nothing and -0.0 matches 0.0.
+ *  - find returns a pointer to the first element equal to val, or last;
+ *  - count returns the number of elements equal to val;
+ *  - remove moves the elements not equal to val to the front, keeping their order, and returns
+ *    the new end. The elements from there to last are left in a valid but unspecified state.
+ *    val must not be one of the elements, since it may be overwritten partway through.
+ */
+
+namespace my {
+    template <class T> const T* find(const T* first, const T* last, const T& val);
+    template <class T> T* find(T* first, T* last, const T& val);
+    template <class T> size_t count(const T* first, const T* last, const T& val);
+    template <class T> T* remove(T* first, T* last, const T& val);
+
+    namespace detail {
+        /* how the SIMD kernels compare a T: as integers of its size, as float or double, or not at all */
+        enum simd_kind {simd_none, simd_int, simd_float, simd_double};
+        template <class T> struct simd_traits {
+            static const simd_kind kind = is_integer<T>::value? simd_int: simd_none;
+        };
+        template <> struct simd_traits<float> {static const simd_kind kind = simd_float;};
+        template <> struct simd_traits<double> {static const simd_kind kind = simd_double;};
+        template <simd_kind K, size_t S> struct simd_tag {};
+
+        template <class T>
+        const T* find_scalar(const T* first, const T* last, const T& val) {
+            for (; first != last; ++first)
+                if (*first == val)
+                    break;
+            return first;
+        }
+        template <class T>
+        size_t count_scalar(const T* first, const T* last, const T& val) {
+            size_t n = 0;
+            for (; first != last; ++first)
+                n += (*first == val);
+            return n;
+        }
+        /* compares with != only, as my::vector::eraseAll always has */
+        template <class T>
+        T* remove_scalar(T* first, T* last, const T& val) {
+            while (first != last && *first != val)
+                ++first;
+            if (first == last) return last;
+            T* out = first;
+            for (++first; first != last; ++first) {
+                if (*first != val) {
+                #if __cplusplus >= 201103L
+                    *out = std::move(*first);
+                #else
+                    *out = *first;
+                #endif
+                    ++out;
+                }
+            }
+            return out;
+        }
+
+        #ifdef MY_SIMD_X86
+        /*----------SSE2: 16 bytes at a time----------*/
+        template <class T> __m128i splat128(const T& val) {
+            // the bits of val in every lane; float and double compare on the same bits
+            unsigned char b[16];
+            for (size_t i = 0; i < 16; i += sizeof(T))
+                memcpy(b + i, &val, sizeof(T));
+            return _mm_loadu_si128((const __m128i*)b);
+        }
+        inline __m128i eq128(__m128i a, __m128i b, simd_tag<simd_int, 1>) {return _mm_cmpeq_epi8(a, b);}
+        inline __m128i eq128(__m128i a, __m128i b, simd_tag<simd_int, 2>) {return _mm_cmpeq_epi16(a, b);}
+        inline __m128i eq128(__m128i a, __m128i b, simd_tag<simd_int, 4>) {return _mm_cmpeq_epi32(a, b);}
+        inline __m128i eq128(__m128i a, __m128i b, simd_tag<simd_int, 8>) {
+            // SSE2 has no 64 bit compare: both 32 bit halves must match
+            __m128i e = _mm_cmpeq_epi32(a, b);
+            return _mm_and_si128(e, _mm_shuffle_epi32(e, _MM_SHUFFLE(2, 3, 0, 1)));
+        }
+        inline __m128i eq128(__m128i a, __m128i b, simd_tag<simd_float, 4>) {
+            return _mm_castps_si128(_mm_cmpeq_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b)));
+        }
+        inline __m128i eq128(__m128i a, __m128i b, simd_tag<simd_double, 8>) {
+            return _mm_castpd_si128(_mm_cmpeq_pd(_mm_castsi128_pd(a), _mm_castsi128_pd(b)));
+        }
+        /* one bit per lane of a compare result */
+        inline unsigned mask128(__m128i e, simd_tag<simd_int, 1>) {return (unsigned)_mm_movemask_epi8(e);}
+        inline unsigned mask128(__m128i e, simd_tag<simd_int, 2>) {return (unsigned)_mm_movemask_epi8(_mm_packs_epi16(e, _mm_setzero_si128()));}
+        template <simd_kind K> unsigned mask128(__m128i e, simd_tag<K, 4>) {return (unsigned)_mm_movemask_ps(_mm_castsi128_ps(e));}
+        template <simd_kind K> unsigned mask128(__m128i e, simd_tag<K, 8>) {return (unsigned)_mm_movemask_pd(_mm_castsi128_pd(e));}
+
+        template <class T>
+        __m128i cmp128(const T* p, __m128i v) {
+            return eq128(_mm_loadu_si128((const __m128i*)p), v, simd_tag<simd_traits<T>::kind, sizeof(T)>());
+        }
+        template <class T>
+        unsigned match128(const T* p, __m128i v) {
+            return mask128(cmp128(p, v), simd_tag<simd_traits<T>::kind, sizeof(T)>());
+        }
+        template <class T>
+        const T* find_sse2(const T* first, const T* last, const T& val) {
+            const size_t lanes = 16 / sizeof(T);
+            __m128i v = splat128(val);
+            for (; (size_t)(last - first) >= lanes; first += lanes)
+                if (unsigned m = match128(first, v))
+                    return first + ctz(m);
+            return find_scalar(first, last, val);
+        }
+        template <class T>
+        size_t count_sse2(const T* first, const T* last, const T& val) {
+            const size_t lanes = 16 / sizeof(T);
+            __m128i v = splat128(val);
+            size_t bytes = 0;
+            // a match sets every byte of its lane, so count matching bytes: each byte of acc counts
+            // up to 255 blocks before psadbw adds them up
+            for (size_t blocks = (last - first) / lanes; blocks != 0; ) {
+                size_t k = (blocks < 255)? blocks: 255;
+                blocks -= k;
+                __m128i acc = _mm_setzero_si128();
+                for (; k != 0; --k, first += lanes)
+                    acc = _mm_sub_epi8(acc, cmp128(first, v));
+                acc = _mm_sad_epu8(acc, _mm_setzero_si128());
+                bytes += (size_t)_mm_cvtsi128_si32(acc) + (size_t)_mm_cvtsi128_si32(_mm_unpackhi_epi64(acc, acc));
+            }
+            return bytes / sizeof(T) + count_scalar(first, last, val);
+        }
+        /* Compacts a register's worth of elements at a time. A block with no match is stored whole;
+         * otherwise each element is written to out and out only advances past those that are kept.
+         * out never passes in, so no write lands on an element that has not been read yet. */
+        template <class T>
+        T* remove_sse2(T* first, T* last, const T& val) {
+            const size_t lanes = 16 / sizeof(T);
+            T* out = const_cast<T*>(find_sse2<T>(first, last, val));
+            if (out == last) return last;
+            __m128i v = splat128(val);
+            T* in = out;
+            for (; (size_t)(last - in) >= lanes; in += lanes) {
+                __m128i x = _mm_loadu_si128((const __m128i*)in);
+                unsigned m = match128(in, v);
+                if (m == 0) {
+                    _mm_storeu_si128((__m128i*)out, x);
+                    out += lanes;
+                    continue;
+                }
+                for (size_t i = 0; i < lanes; ++i) {
+                    *out = in[i];
+                    out += !((m >> i) & 1);
+                }
+            }
+            for (; in != last; ++in) {
+                *out = *in;
+                out += !(*in == val);
+            }
+            return out;
+        }
+
+        /*----------AVX2: 32 bytes at a time, compiled for AVX2 whatever the flags----------*/
+        #define MY_AVX2 __attribute__((target("avx2")))
+        template <class T> MY_AVX2 __m256i splat256(const T& val) {
+            unsigned char b[32];
+            for (size_t i = 0; i < 32; i += sizeof(T))
+                memcpy(b + i, &val, sizeof(T));
+            return _mm256_loadu_si256((const __m256i*)b);
+        }
+        MY_AVX2 inline __m256i eq256(__m256i a, __m256i b, simd_tag<simd_int, 1>) {return _mm256_cmpeq_epi8(a, b);}
+        MY_AVX2 inline __m256i eq256(__m256i a, __m256i b, simd_tag<simd_int, 2>) {return _mm256_cmpeq_epi16(a, b);}
+        MY_AVX2 inline __m256i eq256(__m256i a, __m256i b, simd_tag<simd_int, 4>) {return _mm256_cmpeq_epi32(a, b);}
+        MY_AVX2 inline __m256i eq256(__m256i a, __m256i b, simd_tag<simd_int, 8>) {return _mm256_cmpeq_epi64(a, b);}
+        MY_AVX2 inline __m256i eq256(__m256i a, __m256i b, simd_tag<simd_float, 4>) {
+            return _mm256_castps_si256(_mm256_cmp_ps(_mm256_castsi256_ps(a), _mm256_castsi256_ps(b), _CMP_EQ_OQ));
+        }
+        MY_AVX2 inline __m256i eq256(__m256i a, __m256i b, simd_tag<simd_double, 8>) {
+            return _mm256_castpd_si256(_mm256_cmp_pd(_mm256_castsi256_pd(a), _mm256_castsi256_pd(b), _CMP_EQ_OQ));
+        }
+        MY_AVX2 inline unsigned mask256(__m256i e, simd_tag<simd_int, 1>) {return (unsigned)_mm256_movemask_epi8(e);}
+        MY_AVX2 inline unsigned mask256(__m256i e, simd_tag<simd_int, 2>) {
+            // packs works within each 128 bit half, leaving the lanes' bits at 0-7 and 16-23
+            unsigned m = (unsigned)_mm256_movemask_epi8(_mm256_packs_epi16(e, _mm256_setzero_si256()));
+            return (m & 0xFF) | ((m >> 8) & 0xFF00);
+        }
+        template <simd_kind K> MY_AVX2 unsigned mask256(__m256i e, simd_tag<K, 4>) {return (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(e));}
+        template <simd_kind K> MY_AVX2 unsigned mask256(__m256i e, simd_tag<K, 8>) {return (unsigned)_mm256_movemask_pd(_mm256_castsi256_pd(e));}
+
+        template <class T>
+        MY_AVX2 __m256i cmp256(const T* p, __m256i v) {
+            return eq256(_mm256_loadu_si256((const __m256i*)p), v, simd_tag<simd_traits<T>::kind, sizeof(T)>());
+        }
+        template <class T>
+        MY_AVX2 unsigned match256(const T* p, __m256i v) {
+            return mask256(cmp256(p, v), simd_tag<simd_traits<T>::kind, sizeof(T)>());
+        }
+        template <class T>
+        MY_AVX2 const T* find_avx2(const T* first, const T* last, const T& val) {
+            const size_t lanes = 32 / sizeof(T);
+            __m256i v = splat256(val);
+            // two registers per iteration, so the loop branch is taken half as often
+            for (; (size_t)(last - first) >= 2 * lanes; first += 2 * lanes) {
+                unsigned m0 = match256(first, v), m1 = match256(first + lanes, v);
+                if (m0 | m1)
+                    return m0? first + ctz(m0): first + lanes + ctz(m1);
+            }
+            if ((size_t)(last - first) >= lanes) {
+                if (unsigned m = match256(first, v))
+                    return first + ctz(m);
+                first += lanes;
+            }
+            return find_scalar(first, last, val);
+        }
+        template <class T>
+        MY_AVX2 size_t count_avx2(const T* first, const T* last, const T& val) {
+            const size_t lanes = 32 / sizeof(T);
+            __m256i v = splat256(val);
+            size_t bytes = 0;
+            for (size_t blocks = (last - first) / lanes; blocks != 0; ) {
+                size_t k = (blocks < 255)? blocks: 255;
+                blocks -= k;
+                __m256i acc = _mm256_setzero_si256();
+                for (; k != 0; --k, first += lanes)
+                    acc = _mm256_sub_epi8(acc, cmp256(first, v));
+                acc = _mm256_sad_epu8(acc, _mm256_setzero_si256());
+                __m128i sum = _mm_add_epi64(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+                bytes += (size_t)_mm_cvtsi128_si32(sum) + (size_t)_mm_cvtsi128_si32(_mm_unpackhi_epi64(sum, sum));
+            }
+            return bytes / sizeof(T) + count_scalar(first, last, val);
+        }
+        /* for 4 byte elements, row m lists the lanes to keep when m marks the ones to drop */
+        struct left_pack_table {
+            unsigned char idx[256][8];
+            left_pack_table() {
+                for (unsigned m = 0; m < 256; ++m) {
+                    unsigned k = 0;
+                    for (unsigned i = 0; i < 8; ++i)
+                        if (!((m >> i) & 1)) idx[m][k++] = (unsigned char)i;
+                    for (; k < 8; ++k) idx[m][k] = 0;
+                }
+            }
+        };
+        inline const left_pack_table& left_pack() {
+            static const left_pack_table t;
+            return t;
+        }
+        /* As remove_sse2, except that a block of 4 byte elements with matches is packed with one
+         * permute and stored whole; the lanes past the kept ones are overwritten later. */
+        template <class T>
+        MY_AVX2 T* remove_avx2(T* first, T* last, const T& val) {
+            const size_t lanes = 32 / sizeof(T);
+            T* out = const_cast<T*>(find_avx2<T>(first, last, val));
+            if (out == last) return last;
+            __m256i v = splat256(val);
+            const left_pack_table& table = left_pack();
+            T* in = out;
+            for (; (size_t)(last - in) >= lanes; in += lanes) {
+                __m256i x = _mm256_loadu_si256((const __m256i*)in);
+                unsigned m = match256(in, v);
+                if (m == 0) {
+                    _mm256_storeu_si256((__m256i*)out, x);
+                    out += lanes;
+                }
+                else if (sizeof(T) == 4) {
+                    __m256i idx = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)table.idx[m]));
+                    _mm256_storeu_si256((__m256i*)out, _mm256_permutevar8x32_epi32(x, idx));
+                    out += lanes - __builtin_popcount(m);
+                }
+                else {
+                    for (size_t i = 0; i < lanes; ++i) {
+                        *out = in[i];
+                        out += !((m >> i) & 1);
+                    }
+                }
+            }
+            for (; in != last; ++in) {
+                *out = *in;
+                out += !(*in == val);
+            }
+            return out;
+        }
+        #undef MY_AVX2
+
+        inline bool has_avx2() {
+            static const bool avx2 = (__builtin_cpu_init(), __builtin_cpu_supports("avx2"));
+            return avx2;
+        }
+        #endif
+
+        /* picks the kernel for T: the vector kernels for the types they handle, else the loops */
+        template <class T, bool = simd_traits<T>::kind != simd_none> struct simd_dispatch {
+            static const T* find(const T* first, const T* last, const T& val) {return find_scalar(first, last, val);}
+            static size_t count(const T* first, const T* last, const T& val) {return count_scalar(first, last, val);}
+            static T* remove(T* first, T* last, const T& val) {return remove_scalar(first, last, val);}
+        };
+        #ifdef MY_SIMD_X86
+        template <class T> struct simd_dispatch<T, true> {
+            static const T* find(const T* first, const T* last, const T& val) {
+                if (has_avx2()) return find_avx2(first, last, val);
+                return find_sse2(first, last, val);
+            }
+            static size_t count(const T* first, const T* last, const T& val) {
+                if (has_avx2()) return count_avx2(first, last, val);
+                return count_sse2(first, last, val);
+            }
+            static T* remove(T* first, T* last, const T& val) {
+                if (has_avx2()) return remove_avx2(first, last, val);
+                return remove_sse2(first, last, val);
+            }
+        };
+        #endif
+    }
+}
+
+template <class T>
+const T* my::find(const T* first, const T* last, const T& val) {
+    return detail::simd_dispatch<T>::find(first, last, val);
+}
+template <class T>
+T* my::find(T* first, T* last, const T& val) {
+    return const_cast<T*>(detail::simd_dispatch<T>::find(first, last, val));
+}
+template <class T>
+size_t my::count(const T* first, const T* last, const T& val) {
+    return detail::simd_dispatch<T>::count(first, last, val);
+}
+template <class T>
+T* my::remove(T* first, T* last, const T& val) {
+    return detail::simd_dispatch<T>::remove(first, last, val);
+}
+
+#endif
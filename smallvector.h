@@ -0,0 +1,187 @@
+#ifndef SMALLVECTOR_H
+#define SMALLVECTOR_H
+
+#include <iostream>
+#include <iterator>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <new>
+#include "utilities.h"
+#include "vectorbase.h"
+#include "vector.h"
+
+/*
+ * A my::vector that keeps its first N elements inside the object itself and only allocates once
+ * it grows past N, so a small_vector that stays small never calls malloc. Past N it behaves like
+ * my::vector: the elements move to the heap and capacity grows by vector_growth<T>. The heap block
+ * is kept until shrink_to_fit(), which moves the elements back inline if they fit.
+ * The interface and iterators are my::vector's, both being a my::vector_base (see vectorbase.h) that
+ * differs only in where its blocks come from. Unlike my::vector, moving or swapping a small_vector
+ * whose elements are inline moves the elements one by one, and invalidates iterators.
+ */
+
+namespace my {
+    template <class T, size_t N = 8> class small_vector;
+}
+template <class T, size_t N>
+class my::small_vector: public my::vector_base<T, my::small_vector<T, N> > {
+    #if __cplusplus >= 201103L
+    static_assert(N > 0, "small_vector needs room for at least one inline element");
+    #endif
+    friend class vector_base<T, small_vector>;
+    typedef vector_base<T, small_vector> base;
+    using base::arr;
+    using base::inUse;
+    using base::allocated;
+    public:
+    small_vector() {arr = inline_data(); allocated = N;}
+    explicit small_vector(size_t n);
+    small_vector(size_t n, const T& val);
+    template<class InputIterator>
+    small_vector(InputIterator begin, InputIterator end) {
+        arr = inline_data(); allocated = N;
+        this->assign(begin, end);
+    }
+    small_vector(const small_vector& vec);
+    ~small_vector() {base::destroy(arr, arr+inUse); deallocate(arr, allocated);}
+    small_vector& operator=(const small_vector& vec);
+    /* true while the elements live inside the object */
+    bool is_small() const {return arr == inline_data();}
+    static size_t inline_capacity() {return N;}
+    /* moves the elements back inline if they fit */
+    void shrink_to_fit() {if (!is_small() && inUse < allocated) this->reallocate(inUse);}
+    void swap(small_vector& vec);
+
+    #if __cplusplus >= 201103L
+    small_vector(std::initializer_list<T> l);
+    small_vector(small_vector&& v);
+    small_vector& operator=(std::initializer_list<T> l);
+    small_vector& operator=(small_vector&& v);
+    #endif
+
+    private:
+    #if __cplusplus >= 201103L
+    alignas(T) unsigned char storage[sizeof(T) * N];
+    #else
+    union {
+        unsigned char bytes[sizeof(T) * N];
+        long double ld; long long ll; void* p; void (*fp)();
+    } storage;
+    #endif
+
+    static const char* name() {return "small_vector";}
+    T* inline_data() const {return (T*)&storage;}
+    /* up to N slots are the inline storage, more come from malloc */
+    T* allocate(size_t& n) {
+        if (n <= N) {
+            n = N;
+            return inline_data();
+        }
+        if (n > (size_t)-1 / sizeof(T)) throw std::bad_alloc();
+        T* p = (T*)malloc(sizeof(T)*n);
+        if (p == NULL) throw std::bad_alloc();
+        return p;
+    }
+    void deallocate(T* p, size_t) {if (p != inline_data()) free(p);}
+    /* a heap block staying on the heap is resized by realloc, as in my::vector */
+    T* try_realloc(size_t n) {
+        if (is_small() || n <= N) return NULL;
+        if (n > (size_t)-1 / sizeof(T)) throw std::bad_alloc();
+        T* p = (T*)realloc((void*)arr, sizeof(T)*n);
+        if (p == NULL) throw std::bad_alloc();
+        return p;
+    }
+    void steal(small_vector& v);
+};
+
+#if __cplusplus >= 201103L
+template <class T, size_t N>
+my::small_vector<T, N>::small_vector(std::initializer_list<T> l): small_vector() {
+    this->reserve(l.size());
+    this->copy(l.begin(), l.end());
+}
+template <class T, size_t N>
+my::small_vector<T, N>::small_vector(small_vector&& v): small_vector() {
+    steal(v);
+}
+template <class T, size_t N>
+my::small_vector<T, N>& my::small_vector<T, N>::operator=(small_vector&& v) {
+    if (this != &v) {
+        base::destroy(arr, arr+inUse);
+        deallocate(arr, allocated);
+        arr = inline_data(); inUse = 0; allocated = N;
+        steal(v);
+    }
+    return *this;
+}
+template <class T, size_t N>
+my::small_vector<T, N>& my::small_vector<T, N>::operator=(std::initializer_list<T> l) {
+    this->clear();
+    this->reserve(l.size());
+    this->copy(l.begin(), l.end());
+    return *this;
+}
+#endif
+
+/* Takes v's elements, leaving v empty: a heap block changes owner, inline elements are moved
+ * into this vector's own inline storage. This vector must be empty and small. */
+template <class T, size_t N>
+void my::small_vector<T, N>::steal(small_vector& v) {
+    if (!v.is_small()) {
+        arr = v.arr; inUse = v.inUse; allocated = v.allocated;
+        v.arr = v.inline_data(); v.inUse = 0; v.allocated = N;
+        return;
+    }
+    for (; inUse < v.inUse; inUse++)
+    #if __cplusplus >= 201103L
+        new (arr+inUse) T(std::move(v.arr[inUse]));
+    #else
+        new (arr+inUse) T(v.arr[inUse]);
+    #endif
+    v.clear();
+}
+template <class T, size_t N>
+my::small_vector<T, N>::small_vector(size_t n) {
+    arr = inline_data(); allocated = N;
+    this->reserve(n);
+    for (; inUse < n; inUse++)
+        new (arr+inUse) T();
+}
+template <class T, size_t N>
+my::small_vector<T, N>::small_vector(size_t n, const T& val) {
+    arr = inline_data(); allocated = N;
+    this->reserve(n);
+    for (; inUse < n; inUse++)
+        new (arr+inUse) T(val);
+}
+template <class T, size_t N>
+my::small_vector<T, N>::small_vector(const small_vector& vec): base() {
+    arr = inline_data(); allocated = N;
+    this->reserve(vec.size());
+    for (; inUse < vec.inUse; inUse++)
+        new (arr+inUse) T(vec.arr[inUse]);
+}
+template <class T, size_t N>
+my::small_vector<T, N>& my::small_vector<T, N>::operator=(const small_vector& vec) {
+    if (this != &vec) {
+        this->clear();
+        this->reserve(vec.size());
+        this->copy(vec.begin(), vec.end());
+    }
+    return *this;
+}
+template <class T, size_t N>
+void my::small_vector<T, N>::swap(small_vector& vec) {
+    if (!is_small() && !vec.is_small()) {
+        this->swap_storage(vec);
+        return;
+    }
+    small_vector temp;
+    temp.steal(vec);
+    vec.steal(*this);
+    this->steal(temp);
+}
+
+#endif
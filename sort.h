@@ -0,0 +1,680 @@
+#ifndef SORT_H
+#define SORT_H
+
+#include <cstddef>
+#include <iterator>
+#include <utility>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#if __cplusplus >= 201103L
+#include <functional>
+#include <type_traits>
+#include <atomic>
+#include <memory>
+#include <thread>
+#endif
+#include "utilities.h"
+
+/*
+ * my::sort(first, last, comp) sorts a random access range with pattern-defeating quicksort
+ * (pdqsort, Orson Peters, zlib licence):
+ *  - ranges under 24 elements are insertion sorted;
+ *  - the pivot is the median of 3, or the median of 3 medians of 3 above 128 elements;
+ *  - a partition that needed no swaps is followed by a bounded insertion sort, so sorted and
+ *    nearly sorted input takes linear time;
+ *  - runs of elements equal to the previous pivot are split off in one pass, so inputs with
+ *    few distinct values take O(n k) for k distinct values;
+ *  - a lopsided partition shuffles a few elements to break the pattern that caused it, and after
+ *    log2(n) such partitions the range is heapsorted, so the worst case is O(n log n);
+ *  - for arithmetic types under my::less/my::greater (or std::less/std::greater) partitioning
+ *    compares a block of elements into an offset buffer first, so it does not branch on the
+ *    outcome of each comparison.
+ * The sort is not stable.
+ *
+ * my::radix_sort(first, last) is an LSD radix sort on radix_bits-bit digits that takes O(n) time
+ * and n elements of scratch memory. It sorts integers of 1, 2, 4 or 8 bytes, float and double.
+ * Signed integers are ordered by flipping the sign bit, and floating point values by flipping the
+ * sign bit of positives and every bit of negatives; -0.0 sorts before 0.0, and NaNs go to the ends
+ * by sign. my::sort(first, last) on a plain array of those types switches to it above
+ * radix_sort_threshold elements, but only for the types of at most 4 bytes. my::radix_sort(first,
+ * last, key) (C++11) sorts any elements stably by a numeric key(element).
+ *
+ * my::parallel_sort (C++11) is a samplesort that spreads the work over threads. It sorts a sample
+ * to pick splitters, has each thread deal its slice of the range into buckets, then sorts the
+ * buckets concurrently with my::sort. Below parallel_sort_threshold elements per thread it just
+ * calls my::sort. comp must not throw, since an exception cannot leave a worker thread.
+ */
+
+#if __cplusplus >= 201103L
+#define MY_SORT_MOVE(x) std::move(x)
+#else
+#define MY_SORT_MOVE(x) (x)
+#endif
+
+namespace my {
+    template <class RandomIt, class Compare> void sort(RandomIt first, RandomIt last, Compare comp);
+    template <class RandomIt> void sort(RandomIt first, RandomIt last);
+    template <class T> void sort(T* first, T* last);
+    template <class T> void radix_sort(T* first, T* last);
+    #if __cplusplus >= 201103L
+    template <class T, class KeyFn> void radix_sort(T* first, T* last, KeyFn key);
+    #endif
+    #if __cplusplus >= 201103L
+    template <class RandomIt, class Compare>
+    void parallel_sort(RandomIt first, RandomIt last, Compare comp, unsigned threads = 0);
+    template <class RandomIt> void parallel_sort(RandomIt first, RandomIt last);
+    #endif
+
+    namespace detail {
+        enum {
+            insertion_sort_threshold = 24,
+            ninther_threshold = 128,
+            partial_insertion_sort_limit = 8,
+            partition_block_size = 64,
+            parallel_sort_threshold = 1 << 16,
+            samplesort_oversampling = 32,
+            samplesort_max_buckets = 256,
+            radix_sort_threshold = 2048,
+            radix_bits = 11
+        };
+        /* whether comp on T is a plain <, > on numbers, where branchless partitioning pays off */
+        template <class T, class Compare> struct is_branchless_compare {
+        #if __cplusplus >= 201103L
+            static const bool value = std::is_arithmetic<T>::value &&
+                (std::is_same<Compare, my::less<T> >::value || std::is_same<Compare, my::greater<T> >::value ||
+                 std::is_same<Compare, std::less<T> >::value || std::is_same<Compare, std::greater<T> >::value);
+        #else
+            static const bool value = false;
+        #endif
+        };
+        /* radix_traits<T>::key maps a T to an unsigned integer with the same order */
+        template <class T> struct radix_traits {
+            static const bool supported = false;
+        };
+        template <class T, class U> struct radix_unsigned {
+            static const bool supported = true;
+            typedef U key_type;
+            static U key(T x) {return (U)x;}
+        };
+        template <class T, class U> struct radix_signed {
+            static const bool supported = true;
+            typedef U key_type;
+            static U key(T x) {return (U)x ^ ((U)1 << (sizeof(U) * 8 - 1));}
+        };
+        template <class T, class U> struct radix_floating {
+            static const bool supported = true;
+            typedef U key_type;
+            static U key(T x) {
+                U bits;
+                memcpy(&bits, &x, sizeof(bits));
+                const U sign = (U)1 << (sizeof(U) * 8 - 1);
+                return (bits & sign)? ~bits: bits | sign;
+            }
+        };
+        template <> struct radix_traits<bool>: radix_unsigned<bool, unsigned char> {};
+        template <> struct radix_traits<unsigned char>: radix_unsigned<unsigned char, unsigned char> {};
+        template <> struct radix_traits<unsigned short>: radix_unsigned<unsigned short, unsigned short> {};
+        template <> struct radix_traits<unsigned int>: radix_unsigned<unsigned int, unsigned int> {};
+        template <> struct radix_traits<unsigned long>: radix_unsigned<unsigned long, unsigned long> {};
+        template <> struct radix_traits<unsigned long long>: radix_unsigned<unsigned long long, unsigned long long> {};
+        template <> struct radix_traits<signed char>: radix_signed<signed char, unsigned char> {};
+        template <> struct radix_traits<short>: radix_signed<short, unsigned short> {};
+        template <> struct radix_traits<int>: radix_signed<int, unsigned int> {};
+        template <> struct radix_traits<long>: radix_signed<long, unsigned long> {};
+        template <> struct radix_traits<long long>: radix_signed<long long, unsigned long long> {};
+        template <> struct radix_traits<char>: radix_signed<char, unsigned char> {
+            // plain char may be unsigned
+            static unsigned char key(char x) {return ((char)-1 < 0)? (unsigned char)x ^ 0x80: (unsigned char)x;}
+        };
+        template <> struct radix_traits<float>: radix_floating<float, unsigned int> {};
+        template <> struct radix_traits<double>: radix_floating<double, unsigned long long> {};
+
+        template <class T> struct radix_key {
+            typename radix_traits<T>::key_type operator()(const T& x) const {return radix_traits<T>::key(x);}
+        };
+        /* LSD radix sort of n records by keyof(record), radix_bits bits per pass, moving between a
+         * and buf. Passes in which every key has the same digit are skipped. Returns whichever of a
+         * and buf holds the result. R must be trivially copyable. */
+        template <class U, class R, class KeyOf>
+        R* lsd_radix_sort(R* a, R* buf, size_t n, KeyOf keyof) {
+            const unsigned bits = (sizeof(U) == 1)? 8: radix_bits;
+            const size_t passes = (sizeof(U) * 8 + bits - 1) / bits, radix = (size_t)1 << bits;
+            const U mask = (U)(radix - 1);
+            size_t* counts = (size_t*)calloc(passes * radix, sizeof(size_t));
+            if (counts == NULL) throw std::bad_alloc();
+            for (size_t i = 0; i < n; ++i) {
+                U k = keyof(a[i]);
+                for (size_t d = 0; d < passes; ++d)
+                    ++counts[d * radix + ((k >> (d * bits)) & mask)];
+            }
+            R* from = a, *to = buf;
+            for (size_t d = 0; d < passes; ++d) {
+                size_t* offset = counts + d * radix;
+                unsigned shift = d * bits;
+                if (offset[(keyof(from[0]) >> shift) & mask] == n) continue;
+                size_t sum = 0;
+                for (size_t b = 0; b < radix; ++b) {
+                    size_t c = offset[b];
+                    offset[b] = sum;
+                    sum += c;
+                }
+                for (size_t i = 0; i < n; ++i)
+                    to[offset[(keyof(from[i]) >> shift) & mask]++] = from[i];
+                R* t = from; from = to; to = t;
+            }
+            free(counts);
+            return from;
+        }
+        /* my::sort(T*, T*) radix sorts keys of at most 4 bytes; 8 byte keys take six passes over
+         * memory, which measured no faster than the branchless pdqsort partition */
+        template <class T, bool = radix_traits<T>::supported && sizeof(T) <= 4> struct ascending_sort {
+            static void sort(T* first, T* last) {my::sort(first, last, my::less<T>());}
+        };
+        template <class T> struct ascending_sort<T, true> {
+            static void sort(T* first, T* last) {
+                if (last - first < radix_sort_threshold) my::sort(first, last, my::less<T>());
+                else my::radix_sort(first, last);
+            }
+        };
+        inline int floor_log2(size_t n) {
+            int log = 0;
+            while (n >>= 1) ++log;
+            return log;
+        }
+        template <class Iter>
+        inline void iter_swap(Iter a, Iter b) {my::swap(*a, *b);}
+
+        template <class Iter, class Compare>
+        inline void sort2(Iter a, Iter b, Compare& comp) {
+            if (comp(*b, *a)) iter_swap(a, b);
+        }
+        template <class Iter, class Compare>
+        inline void sort3(Iter a, Iter b, Iter c, Compare& comp) {
+            sort2(a, b, comp);
+            sort2(b, c, comp);
+            sort2(a, b, comp);
+        }
+        template <class Iter, class Compare>
+        void insertion_sort(Iter begin, Iter end, Compare& comp) {
+            typedef typename std::iterator_traits<Iter>::value_type T;
+            if (begin == end) return;
+            for (Iter cur = begin + 1; cur != end; ++cur) {
+                Iter sift = cur, sift_1 = cur - 1;
+                if (comp(*sift, *sift_1)) {
+                    T tmp(MY_SORT_MOVE(*sift));
+                    do {
+                        *sift-- = MY_SORT_MOVE(*sift_1);
+                    } while (sift != begin && comp(tmp, *--sift_1));
+                    *sift = MY_SORT_MOVE(tmp);
+                }
+            }
+        }
+        /* as above, but *(begin - 1) must exist and not be greater than any element of the range */
+        template <class Iter, class Compare>
+        void unguarded_insertion_sort(Iter begin, Iter end, Compare& comp) {
+            typedef typename std::iterator_traits<Iter>::value_type T;
+            if (begin == end) return;
+            for (Iter cur = begin + 1; cur != end; ++cur) {
+                Iter sift = cur, sift_1 = cur - 1;
+                if (comp(*sift, *sift_1)) {
+                    T tmp(MY_SORT_MOVE(*sift));
+                    do {
+                        *sift-- = MY_SORT_MOVE(*sift_1);
+                    } while (comp(tmp, *--sift_1));
+                    *sift = MY_SORT_MOVE(tmp);
+                }
+            }
+        }
+        /* Insertion sorts the range but gives up after moving partial_insertion_sort_limit
+         * elements; returns whether the range ended up sorted. */
+        template <class Iter, class Compare>
+        bool partial_insertion_sort(Iter begin, Iter end, Compare& comp) {
+            typedef typename std::iterator_traits<Iter>::value_type T;
+            if (begin == end) return true;
+            size_t moved = 0;
+            for (Iter cur = begin + 1; cur != end; ++cur) {
+                Iter sift = cur, sift_1 = cur - 1;
+                if (comp(*sift, *sift_1)) {
+                    T tmp(MY_SORT_MOVE(*sift));
+                    do {
+                        *sift-- = MY_SORT_MOVE(*sift_1);
+                    } while (sift != begin && comp(tmp, *--sift_1));
+                    *sift = MY_SORT_MOVE(tmp);
+                    moved += cur - sift;
+                }
+                if (moved > partial_insertion_sort_limit) return false;
+            }
+            return true;
+        }
+        template <class Iter, class Compare>
+        void sift_down(Iter begin, size_t i, size_t n, Compare& comp) {
+            typedef typename std::iterator_traits<Iter>::value_type T;
+            T tmp(MY_SORT_MOVE(begin[i]));
+            for (size_t child; (child = 2 * i + 1) < n; i = child) {
+                if (child + 1 < n && comp(begin[child], begin[child + 1])) ++child;
+                if (!comp(tmp, begin[child])) break;
+                begin[i] = MY_SORT_MOVE(begin[child]);
+            }
+            begin[i] = MY_SORT_MOVE(tmp);
+        }
+        template <class Iter, class Compare>
+        void heap_sort(Iter begin, Iter end, Compare& comp) {
+            size_t n = end - begin;
+            for (size_t i = n / 2; i-- > 0; )
+                sift_down(begin, i, n, comp);
+            while (n > 1) {
+                iter_swap(begin, begin + --n);
+                sift_down(begin, 0, n, comp);
+            }
+        }
+        /* Partitions around the pivot *begin, putting elements equal to it on the right. Returns
+         * the pivot's final place and whether the range was already partitioned. */
+        template <class Iter, class Compare>
+        std::pair<Iter, bool> partition_right(Iter begin, Iter end, Compare& comp) {
+            typedef typename std::iterator_traits<Iter>::value_type T;
+            T pivot(MY_SORT_MOVE(*begin));
+            Iter first = begin, last = end;
+            // the median of 3 guarantees an element >= pivot to the right, and one < pivot ends a left scan
+            while (comp(*++first, pivot));
+            if (first - 1 == begin)
+                while (first < last && !comp(*--last, pivot));
+            else
+                while (!comp(*--last, pivot));
+            bool already_partitioned = first >= last;
+            while (first < last) {
+                iter_swap(first, last);
+                while (comp(*++first, pivot));
+                while (!comp(*--last, pivot));
+            }
+            Iter pivot_pos = first - 1;
+            *begin = MY_SORT_MOVE(*pivot_pos);
+            *pivot_pos = MY_SORT_MOVE(pivot);
+            return std::pair<Iter, bool>(pivot_pos, already_partitioned);
+        }
+        /* Swaps the misplaced elements found by partition_right_branchless. When both sides found
+         * the same number they are swapped pairwise, otherwise rotated through one temporary. */
+        template <class Iter>
+        void swap_offsets(Iter first, Iter last, const unsigned char* offsets_l, const unsigned char* offsets_r,
+                          size_t num, bool use_swaps) {
+            typedef typename std::iterator_traits<Iter>::value_type T;
+            if (use_swaps) {
+                for (size_t i = 0; i < num; ++i)
+                    iter_swap(first + offsets_l[i], last - offsets_r[i]);
+            }
+            else if (num > 0) {
+                Iter l = first + offsets_l[0], r = last - offsets_r[0];
+                T tmp(MY_SORT_MOVE(*l));
+                *l = MY_SORT_MOVE(*r);
+                for (size_t i = 1; i < num; ++i) {
+                    l = first + offsets_l[i];
+                    *r = MY_SORT_MOVE(*l);
+                    r = last - offsets_r[i];
+                    *l = MY_SORT_MOVE(*r);
+                }
+                *r = MY_SORT_MOVE(tmp);
+            }
+        }
+        /* partition_right for cheap comparisons: each side scans a block of up to
+         * partition_block_size elements and records the offsets of the misplaced ones, adding the
+         * comparison result to a counter instead of branching on it; the recorded elements are
+         * then swapped across. */
+        template <class Iter, class Compare>
+        std::pair<Iter, bool> partition_right_branchless(Iter begin, Iter end, Compare& comp) {
+            typedef typename std::iterator_traits<Iter>::value_type T;
+            T pivot(MY_SORT_MOVE(*begin));
+            Iter first = begin, last = end;
+            while (comp(*++first, pivot));
+            if (first - 1 == begin)
+                while (first < last && !comp(*--last, pivot));
+            else
+                while (!comp(*--last, pivot));
+            bool already_partitioned = first >= last;
+            if (!already_partitioned) {
+                iter_swap(first, last);
+                ++first;
+                unsigned char offsets_l_buf[partition_block_size], offsets_r_buf[partition_block_size];
+                unsigned char* offsets_l = offsets_l_buf;
+                unsigned char* offsets_r = offsets_r_buf;
+                Iter offsets_l_base = first, offsets_r_base = last;
+                size_t num_l = 0, num_r = 0, start_l = 0, start_r = 0;
+                while (first < last) {
+                    // fill whichever buffer is empty; split the unknown part when both are
+                    size_t num_unknown = last - first;
+                    size_t left_split = (num_l == 0)? ((num_r == 0)? num_unknown / 2: num_unknown): 0;
+                    size_t right_split = (num_r == 0)? num_unknown - left_split: 0;
+                    if (left_split >= partition_block_size) {
+                        for (size_t i = 0; i < partition_block_size; ) {
+                            offsets_l[num_l] = (unsigned char)i++; num_l += !comp(*first, pivot); ++first;
+                            offsets_l[num_l] = (unsigned char)i++; num_l += !comp(*first, pivot); ++first;
+                            offsets_l[num_l] = (unsigned char)i++; num_l += !comp(*first, pivot); ++first;
+                            offsets_l[num_l] = (unsigned char)i++; num_l += !comp(*first, pivot); ++first;
+                        }
+                    }
+                    else {
+                        for (size_t i = 0; i < left_split; ) {
+                            offsets_l[num_l] = (unsigned char)i++; num_l += !comp(*first, pivot); ++first;
+                        }
+                    }
+                    if (right_split >= partition_block_size) {
+                        for (size_t i = 0; i < partition_block_size; ) {
+                            offsets_r[num_r] = (unsigned char)++i; num_r += comp(*--last, pivot);
+                            offsets_r[num_r] = (unsigned char)++i; num_r += comp(*--last, pivot);
+                            offsets_r[num_r] = (unsigned char)++i; num_r += comp(*--last, pivot);
+                            offsets_r[num_r] = (unsigned char)++i; num_r += comp(*--last, pivot);
+                        }
+                    }
+                    else {
+                        for (size_t i = 0; i < right_split; ) {
+                            offsets_r[num_r] = (unsigned char)++i; num_r += comp(*--last, pivot);
+                        }
+                    }
+                    size_t num = (num_l < num_r)? num_l: num_r;
+                    swap_offsets(offsets_l_base, offsets_r_base, offsets_l + start_l, offsets_r + start_r,
+                                 num, num_l == num_r);
+                    num_l -= num; num_r -= num;
+                    start_l += num; start_r += num;
+                    if (num_l == 0) {
+                        start_l = 0;
+                        offsets_l_base = first;
+                    }
+                    if (num_r == 0) {
+                        start_r = 0;
+                        offsets_r_base = last;
+                    }
+                }
+                // one buffer may still hold misplaced elements; move them to the boundary
+                if (num_l) {
+                    offsets_l += start_l;
+                    while (num_l--)
+                        iter_swap(offsets_l_base + offsets_l[num_l], --last);
+                    first = last;
+                }
+                if (num_r) {
+                    offsets_r += start_r;
+                    while (num_r--) {
+                        iter_swap(offsets_r_base - offsets_r[num_r], first);
+                        ++first;
+                    }
+                    last = first;
+                }
+            }
+            Iter pivot_pos = first - 1;
+            *begin = MY_SORT_MOVE(*pivot_pos);
+            *pivot_pos = MY_SORT_MOVE(pivot);
+            return std::pair<Iter, bool>(pivot_pos, already_partitioned);
+        }
+        /* Partitions around the pivot *begin, putting elements equal to it on the left. Used when
+         * the pivot equals the element before the range, so everything equal to it is done. */
+        template <class Iter, class Compare>
+        Iter partition_left(Iter begin, Iter end, Compare& comp) {
+            typedef typename std::iterator_traits<Iter>::value_type T;
+            T pivot(MY_SORT_MOVE(*begin));
+            Iter first = begin, last = end;
+            while (comp(pivot, *--last));
+            if (last + 1 == end)
+                while (first < last && !comp(pivot, *++first));
+            else
+                while (!comp(pivot, *++first));
+            while (first < last) {
+                iter_swap(first, last);
+                while (comp(pivot, *--last));
+                while (!comp(pivot, *++first));
+            }
+            Iter pivot_pos = last;
+            *begin = MY_SORT_MOVE(*pivot_pos);
+            *pivot_pos = MY_SORT_MOVE(pivot);
+            return pivot_pos;
+        }
+        /* Sorts [begin, end), recursing on the left part and looping on the right. leftmost is
+         * false when *(begin - 1) is a previous pivot, which is a sentinel for the insertion sort. */
+        template <bool Branchless, class Iter, class Compare>
+        void pdqsort_loop(Iter begin, Iter end, Compare& comp, int bad_allowed, bool leftmost) {
+            typedef typename std::iterator_traits<Iter>::difference_type diff_t;
+            while (true) {
+                diff_t size = end - begin;
+                if (size < insertion_sort_threshold) {
+                    if (leftmost) insertion_sort(begin, end, comp);
+                    else unguarded_insertion_sort(begin, end, comp);
+                    return;
+                }
+                // move the chosen pivot to *begin
+                diff_t s2 = size / 2;
+                if (size > ninther_threshold) {
+                    sort3(begin, begin + s2, end - 1, comp);
+                    sort3(begin + 1, begin + (s2 - 1), end - 2, comp);
+                    sort3(begin + 2, begin + (s2 + 1), end - 3, comp);
+                    sort3(begin + (s2 - 1), begin + s2, begin + (s2 + 1), comp);
+                    iter_swap(begin, begin + s2);
+                }
+                else
+                    sort3(begin + s2, begin, end - 1, comp);
+
+                // pivot equal to the previous one: put all of its copies left and skip them
+                if (!leftmost && !comp(*(begin - 1), *begin)) {
+                    begin = partition_left(begin, end, comp) + 1;
+                    continue;
+                }
+                std::pair<Iter, bool> part = Branchless? partition_right_branchless(begin, end, comp)
+                                                       : partition_right(begin, end, comp);
+                Iter pivot_pos = part.first;
+                diff_t l_size = pivot_pos - begin, r_size = end - (pivot_pos + 1);
+                if (l_size < size / 8 || r_size < size / 8) {
+                    if (--bad_allowed == 0) {
+                        heap_sort(begin, end, comp);
+                        return;
+                    }
+                    // break up whatever pattern produced the bad pivot
+                    if (l_size >= insertion_sort_threshold) {
+                        iter_swap(begin, begin + l_size / 4);
+                        iter_swap(pivot_pos - 1, pivot_pos - l_size / 4);
+                        if (l_size > ninther_threshold) {
+                            iter_swap(begin + 1, begin + (l_size / 4 + 1));
+                            iter_swap(begin + 2, begin + (l_size / 4 + 2));
+                            iter_swap(pivot_pos - 2, pivot_pos - (l_size / 4 + 1));
+                            iter_swap(pivot_pos - 3, pivot_pos - (l_size / 4 + 2));
+                        }
+                    }
+                    if (r_size >= insertion_sort_threshold) {
+                        iter_swap(pivot_pos + 1, pivot_pos + (1 + r_size / 4));
+                        iter_swap(end - 1, end - r_size / 4);
+                        if (r_size > ninther_threshold) {
+                            iter_swap(pivot_pos + 2, pivot_pos + (2 + r_size / 4));
+                            iter_swap(pivot_pos + 3, pivot_pos + (3 + r_size / 4));
+                            iter_swap(end - 2, end - (1 + r_size / 4));
+                            iter_swap(end - 3, end - (2 + r_size / 4));
+                        }
+                    }
+                }
+                else if (part.second && partial_insertion_sort(begin, pivot_pos, comp)
+                                     && partial_insertion_sort(pivot_pos + 1, end, comp))
+                    return;  // no swaps were needed, and both sides were (nearly) sorted already
+
+                pdqsort_loop<Branchless>(begin, pivot_pos, comp, bad_allowed, leftmost);
+                begin = pivot_pos + 1;
+                leftmost = false;
+            }
+        }
+    }
+}
+#if __cplusplus >= 201103L
+namespace my {
+    namespace detail {
+        /* runs f(0) .. f(n-1) on n threads, the calling thread taking f(0). If f(0) or starting a
+         * thread throws, the threads already started are joined before the exception goes on, as
+         * destroying a joinable std::thread calls std::terminate. */
+        template <class F>
+        void run_parallel(unsigned n, const F& f) {
+            std::unique_ptr<std::thread[]> pool(new std::thread[n - 1]);
+            unsigned started = 1;
+            try {
+                for (; started < n; ++started)
+                    pool[started - 1] = std::thread(f, started);
+                f(0);
+            }
+            catch (...) {
+                for (unsigned i = 1; i < started; ++i)
+                    pool[i - 1].join();
+                throw;
+            }
+            for (unsigned i = 1; i < n; ++i)
+                pool[i - 1].join();
+        }
+    }
+}
+#endif
+template <class RandomIt, class Compare>
+void my::sort(RandomIt first, RandomIt last, Compare comp) {
+    typedef typename std::iterator_traits<RandomIt>::value_type T;
+    if (last - first < 2) return;
+    detail::pdqsort_loop<detail::is_branchless_compare<T, Compare>::value>(
+        first, last, comp, detail::floor_log2(last - first), true);
+}
+template <class RandomIt>
+void my::sort(RandomIt first, RandomIt last) {
+    my::sort(first, last, my::less<typename std::iterator_traits<RandomIt>::value_type>());
+}
+template <class T>
+void my::sort(T* first, T* last) {
+    detail::ascending_sort<T>::sort(first, last);
+}
+template <class T>
+void my::radix_sort(T* first, T* last) {
+    typedef detail::radix_traits<T> traits;
+    size_t n = last - first;
+    if (n < 2) return;
+    T* buf = (T*)malloc(sizeof(T) * n);
+    if (buf == NULL) {
+        my::sort(first, last, my::less<T>());
+        return;
+    }
+    T* sorted = detail::lsd_radix_sort<typename traits::key_type>(first, buf, n, detail::radix_key<T>());
+    if (sorted != first)
+        memcpy((void*)first, (const void*)sorted, sizeof(T) * n);
+    free(buf);
+}
+#if __cplusplus >= 201103L
+template <class T, class KeyFn>
+void my::radix_sort(T* first, T* last, KeyFn key) {
+    typedef typename std::decay<decltype(key(*first))>::type K;
+    typedef detail::radix_traits<K> traits;
+    static_assert(traits::supported, "radix_sort needs a key of integer, float or double type");
+    typedef typename traits::key_type U;
+    // sort (key, position) records, then move the elements into the order they give
+    struct record {
+        U key;
+        size_t pos;
+    };
+    size_t n = last - first;
+    if (n < 2) return;
+    record* a = (record*)malloc(sizeof(record) * n);
+    record* b = (a == NULL)? NULL: (record*)malloc(sizeof(record) * n);
+    T* tmp = (b == NULL)? NULL: (T*)malloc(sizeof(T) * n);
+    if (tmp == NULL) {
+        free(a); free(b);
+        throw std::bad_alloc();
+    }
+    for (size_t i = 0; i < n; ++i) {
+        a[i].key = traits::key(key(first[i]));
+        a[i].pos = i;
+    }
+    record* sorted = detail::lsd_radix_sort<U>(a, b, n, [](const record& r) {return r.key;});
+    for (size_t i = 0; i < n; ++i)
+        new (tmp + i) T(std::move(first[sorted[i].pos]));
+    for (size_t i = 0; i < n; ++i) {
+        first[i] = std::move(tmp[i]);
+        tmp[i].~T();
+    }
+    free(a); free(b); free(tmp);
+}
+#endif
+
+#if __cplusplus >= 201103L
+template <class RandomIt, class Compare>
+void my::parallel_sort(RandomIt first, RandomIt last, Compare comp, unsigned threads) {
+    typedef typename std::iterator_traits<RandomIt>::value_type T;
+    size_t n = last - first;
+    if (threads == 0) threads = std::thread::hardware_concurrency();
+    if (threads > n / detail::parallel_sort_threshold) threads = n / detail::parallel_sort_threshold;
+    // a few buckets per thread, so that an uneven split still keeps every thread busy
+    size_t buckets = (threads * 4 < (size_t)detail::samplesort_max_buckets)? threads * 4: (size_t)detail::samplesort_max_buckets;
+    T* tmp = (threads < 2)? NULL: (T*)malloc(sizeof(T) * n);
+    unsigned char* ids = (tmp == NULL)? NULL: (unsigned char*)malloc(n);
+    if (ids == NULL) {
+        free(tmp);
+        my::sort(first, last, comp);
+        return;
+    }
+    // sort a random sample (by index, so T needs no default constructor) and take evenly spaced splitters
+    size_t samples = buckets * detail::samplesort_oversampling;
+    std::unique_ptr<size_t[]> sample(new size_t[samples]);
+    unsigned long long seed = 0x9e3779b97f4a7c15ULL ^ n;
+    for (size_t i = 0; i < samples; ++i) {
+        seed ^= seed << 13; seed ^= seed >> 7; seed ^= seed << 17;
+        sample[i] = (size_t)(seed % n);
+    }
+    my::sort(sample.get(), sample.get() + samples, [&](size_t a, size_t b) {return comp(first[a], first[b]);});
+    std::unique_ptr<size_t[]> splitter(new size_t[buckets - 1]);
+    for (size_t b = 1; b < buckets; ++b)
+        splitter[b - 1] = sample[b * detail::samplesort_oversampling];
+
+    // each thread labels its slice with bucket numbers and counts them
+    std::unique_ptr<size_t[]> counts(new size_t[threads * buckets]());
+    auto slice_begin = [&](size_t t) {return n / threads * t;};
+    auto slice_end = [&](size_t t) {return (t + 1 == threads)? n: n / threads * (t + 1);};
+    detail::run_parallel(threads, [&](unsigned t) {
+        size_t* count = counts.get() + t * buckets;
+        for (size_t i = slice_begin(t); i < slice_end(t); ++i) {
+            size_t lo = 0, hi = buckets - 1;  // the number of splitters <= first[i]
+            while (lo < hi) {
+                size_t mid = (lo + hi) / 2;
+                if (comp(first[i], first[splitter[mid]])) hi = mid;
+                else lo = mid + 1;
+            }
+            ids[i] = (unsigned char)lo;
+            ++count[lo];
+        }
+    });
+    // turn the counts into write positions: bucket by bucket, and within a bucket thread by thread
+    std::unique_ptr<size_t[]> bucket_start(new size_t[buckets + 1]);
+    size_t pos = 0;
+    for (size_t b = 0; b < buckets; ++b) {
+        bucket_start[b] = pos;
+        for (size_t t = 0; t < threads; ++t) {
+            size_t c = counts[t * buckets + b];
+            counts[t * buckets + b] = pos;
+            pos += c;
+        }
+    }
+    bucket_start[buckets] = n;
+    // once every label is known, the threads move their slices into the buckets in tmp
+    detail::run_parallel(threads, [&](unsigned t) {
+        size_t* next = counts.get() + t * buckets;
+        for (size_t i = slice_begin(t); i < slice_end(t); ++i)
+            new (tmp + next[ids[i]]++) T(std::move(first[i]));
+    });
+    // each thread takes the next unsorted bucket, sorts it and moves it back into place
+    std::atomic<size_t> next_bucket(0);
+    detail::run_parallel(threads, [&](unsigned) {
+        for (size_t b; (b = next_bucket++) < buckets; ) {
+            T* lo = tmp + bucket_start[b], *hi = tmp + bucket_start[b + 1];
+            my::sort(lo, hi, comp);
+            RandomIt out = first + bucket_start[b];
+            for (T* p = lo; p != hi; ++p, ++out) {
+                *out = std::move(*p);
+                p->~T();
+            }
+        }
+    });
+    free(ids);
+    free(tmp);
+}
+template <class RandomIt>
+void my::parallel_sort(RandomIt first, RandomIt last) {
+    my::parallel_sort(first, last, my::less<typename std::iterator_traits<RandomIt>::value_type>());
+}
+#endif
+
+#undef MY_SORT_MOVE
+
+#endif
@@ -0,0 +1,490 @@
+#ifndef SWISSMAP_H
+#define SWISSMAP_H
+
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <new>
+#if __cplusplus >= 201103L
+#include <tuple>
+#endif
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include "utilities.h" //for equals
+#include "hash.h"
+
+/*
+ * Open-addressing hash map in the style of Abseil's "Swiss table".
+ * Every slot has a one byte control word: empty, deleted, or the low 7 bits of the key's hash.
+ * Control bytes are probed 16 at a time (one SSE2 compare), and only slots whose control byte
+ * matches are compared against the key, so a lookup usually touches one control group and one slot.
+ * Slots are stored flat in a single array; there is no per-entry allocation.
+ */
+
+namespace my {
+    namespace swiss {
+        typedef signed char ctrl_t;
+        const ctrl_t kEmpty = -128;  // 0b10000000
+        const ctrl_t kDeleted = -2;  // 0b11111110
+        const size_t kGroupWidth = 16;
+
+        inline unsigned lowest_bit(unsigned mask) {return my::ctz(mask);}
+        /*----------one probe window of control bytes, each match returns a 16 bit mask----------*/
+        struct Group {
+        #ifdef __SSE2__
+            __m128i ctrl;
+            explicit Group(const ctrl_t* p): ctrl(_mm_loadu_si128((const __m128i*)p)) {}
+            unsigned match(ctrl_t h2) const {
+                return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl));
+            }
+            unsigned match_empty() const {
+                return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(kEmpty), ctrl));
+            }
+            // empty and deleted are the only negative values other than -1, which is never used
+            unsigned match_empty_or_deleted() const {
+                return _mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(-1), ctrl));
+            }
+            unsigned match_full() const {
+                return ~_mm_movemask_epi8(ctrl) & 0xFFFF;
+            }
+        #else
+            const ctrl_t* ctrl;
+            explicit Group(const ctrl_t* p): ctrl(p) {}
+            unsigned match(ctrl_t h2) const {
+                unsigned mask = 0;
+                for (size_t i = 0; i < kGroupWidth; ++i)
+                    if (ctrl[i] == h2) mask |= 1u << i;
+                return mask;
+            }
+            unsigned match_empty() const {return match(kEmpty);}
+            unsigned match_empty_or_deleted() const {
+                unsigned mask = 0;
+                for (size_t i = 0; i < kGroupWidth; ++i)
+                    if (ctrl[i] < -1) mask |= 1u << i;
+                return mask;
+            }
+            unsigned match_full() const {
+                unsigned mask = 0;
+                for (size_t i = 0; i < kGroupWidth; ++i)
+                    if (ctrl[i] >= 0) mask |= 1u << i;
+                return mask;
+            }
+        #endif
+        };
+    }
+    template <class K, class V, class C = my::equals<K>, class H = hash> class swiss_map;
+}
+template <class K, class V, class C, class H>
+class my::swiss_map {
+    template <class T> class swiss_iterator {
+        public:
+        typedef T value_type;
+        typedef T& reference;
+        typedef T* pointer;
+        typedef std::forward_iterator_tag iterator_category;
+        typedef void difference_type;
+        swiss_iterator(const swiss_map* a = NULL, size_t i = 0): m(a), index(i) {}
+        bool operator==(const swiss_iterator& it) const {return index == it.index;}
+        bool operator!=(const swiss_iterator& it) const {return index != it.index;}
+        swiss_iterator& operator++() {
+            index = m->next_full(index+1);
+            return *this;
+        }
+        swiss_iterator operator++(int) {swiss_iterator it = *this; ++*this; return it;}
+        reference operator*() const {return m->slots[index];}
+        pointer operator->() const {return &(m->slots[index]);}
+
+        private:
+        const swiss_map* m;
+        size_t index;
+    };
+    public:
+    typedef size_t size_type;
+    typedef std::pair<const K, V> value_type;
+    typedef swiss_iterator<value_type> iterator;
+    typedef swiss_iterator<const value_type> const_iterator;
+
+    swiss_map(size_t size, const C& compfunc = C(), const H& hashfunc = H()):
+        ctrl(NULL), slots(NULL), cap(0), count(0), used(0), hash(hashfunc), comp(compfunc) {
+        reserve(size);
+    }
+    swiss_map(const C& compfunc = C(), const H& hashfunc = H()):
+        ctrl(NULL), slots(NULL), cap(0), count(0), used(0), hash(hashfunc), comp(compfunc) {}
+    #if __cplusplus >= 201103L
+    swiss_map(std::initializer_list<value_type> l): ctrl(NULL), slots(NULL), cap(0), count(0), used(0) {
+        reserve(l.size());
+        insert(l);
+    }
+    swiss_map(swiss_map&& m): ctrl(m.ctrl), slots(m.slots), cap(m.cap), count(m.count), used(m.used),
+        hash(m.hash), comp(m.comp) {
+        m.ctrl = NULL; m.slots = NULL;
+        m.cap = m.count = m.used = 0;
+    }
+    #endif
+    template <class InputIterator>
+    swiss_map(InputIterator first, InputIterator last): ctrl(NULL), slots(NULL), cap(0), count(0), used(0) {
+        insert(first, last);
+    }
+    swiss_map(const swiss_map& m): ctrl(NULL), slots(NULL), cap(0), count(0), used(0), hash(m.hash), comp(m.comp) {
+        reserve(m.count);
+        copy(m);
+    }
+    ~swiss_map() {clear(); deallocate();}
+
+    std::pair<value_type*, bool> insert(const value_type& p) {
+        size_t h = hash_of(p.first);
+        size_t index = find_index(p.first, h);
+        if (index != cap)
+            return std::pair<value_type*, bool>(&slots[index], false);
+        index = prepare_insert(h);
+        new (&slots[index]) value_type(p);
+        publish(index, h);
+        return std::pair<value_type*, bool>(&slots[index], true);
+    }
+    /* Forward ranges are counted first so the table is sized once, up front, instead of
+     * doubling (and incrementally rehashing) its way through a bulk load. */
+    template <class InputIterator>
+    void insert(InputIterator first, InputIterator last) {
+        insert_range(first, last, typename std::iterator_traits<InputIterator>::iterator_category());
+    }
+    #if __cplusplus >= 201103L
+    void insert(std::initializer_list<value_type> l) {insert(l.begin(), l.end());}
+    std::pair<value_type*, bool> insert(value_type&& p) {
+        size_t h = hash_of(p.first);
+        size_t index = find_index(p.first, h);
+        if (index != cap)
+            return std::pair<value_type*, bool>(&slots[index], false);
+        index = prepare_insert(h);
+        new (&slots[index]) value_type(std::move(p));
+        publish(index, h);
+        return std::pair<value_type*, bool>(&slots[index], true);
+    }
+    /* The slot depends on the key, so the pair is built once outside the table and moved in;
+     * prefer try_emplace, which builds it in place and only when the key is absent. */
+    template <class... Args>
+    std::pair<value_type*, bool> emplace(Args&&... args) {
+        return insert(value_type(std::forward<Args>(args)...));
+    }
+    template <class... Args>
+    std::pair<value_type*, bool> try_emplace(const K& key, Args&&... args) {
+        return emplace_key(key, std::forward<Args>(args)...);
+    }
+    template <class... Args>
+    std::pair<value_type*, bool> try_emplace(K&& key, Args&&... args) {
+        return emplace_key(std::move(key), std::forward<Args>(args)...);
+    }
+    template <class M>
+    std::pair<value_type*, bool> insert_or_assign(const K& key, M&& obj) {
+        return assign_key(key, std::forward<M>(obj));
+    }
+    template <class M>
+    std::pair<value_type*, bool> insert_or_assign(K&& key, M&& obj) {
+        return assign_key(std::move(key), std::forward<M>(obj));
+    }
+    #endif
+    void erase(const K& val) {erase_key(val);}
+
+    value_type* find(const K& val) {return find_key(val);}
+
+    /* Looks up n keys at once, storing a pointer to each entry (or NULL) in out. Each key's
+     * control group and slots are prefetched a few keys ahead of the probe that reads them. */
+    void find_many(const K* keys, size_t n, value_type** out) {find_many_keys(keys, n, out);}
+
+    V& at(const K& val) {return at_key(val);}
+
+    #if __cplusplus >= 201703L
+    /* heterogeneous lookup, as in my::map: needs is_transparent on both H and C */
+    template <class Key, class HH = H, class = typename HH::is_transparent, class CC = C, class = typename CC::is_transparent>
+    void erase(const Key& val) {erase_key(val);}
+
+    template <class Key, class HH = H, class = typename HH::is_transparent, class CC = C, class = typename CC::is_transparent>
+    value_type* find(const Key& val) {return find_key(val);}
+
+    template <class Key, class HH = H, class = typename HH::is_transparent, class CC = C, class = typename CC::is_transparent>
+    void find_many(const Key* keys, size_t n, value_type** out) {find_many_keys(keys, n, out);}
+
+    template <class Key, class HH = H, class = typename HH::is_transparent, class CC = C, class = typename CC::is_transparent>
+    V& at(const Key& val) {return at_key(val);}
+    #endif
+    #if __cplusplus >= 201103L
+    V& operator[](const K& val) {return try_emplace(val).first->second;}
+
+    V& operator[](K&& val) {return try_emplace(std::move(val)).first->second;}
+    #else
+    V& operator[](const K& val) {
+        value_type* p = find(val);
+        if (p != NULL)
+            return p->second;
+        return insert(value_type(val, V())).first->second;
+    }
+    #endif
+    #if __cplusplus >= 201103L
+    swiss_map& operator=(std::initializer_list<value_type> l) {
+        clear();
+        insert(l);
+        return *this;
+    }
+    swiss_map& operator=(swiss_map&& m) {
+        if (this != &m) {
+            clear();
+            deallocate();
+            ctrl = m.ctrl; m.ctrl = NULL;
+            slots = m.slots; m.slots = NULL;
+            cap = m.cap; m.cap = 0;
+            count = m.count; m.count = 0;
+            used = m.used; m.used = 0;
+            hash = m.hash;
+            comp = m.comp;
+        }
+        return *this;
+    }
+    #endif
+    swiss_map& operator=(const swiss_map& m) {
+        if (this != &m) {
+            clear();
+            copy(m);
+        }
+        return *this;
+    }
+    template <class InputIterator>
+    void assign(InputIterator first, InputIterator last) {
+        clear();
+        insert(first, last);
+    }
+    size_t size() const {return count;}
+
+    bool empty() const {return count == 0;}
+
+    size_t capacity() const {return cap;}
+
+    void reserve(size_t n) {
+        size_t c = swiss::kGroupWidth;
+        while (c - c/8 < n) c *= 2;
+        if (c > cap) rehash(c);
+    }
+    void clear() {
+        for (size_t i = 0; i < cap; ++i) {
+            if (ctrl[i] >= 0)
+                slots[i].~value_type();
+            ctrl[i] = swiss::kEmpty;
+        }
+        count = used = 0;
+    }
+    iterator begin() {return iterator(this, next_full(0));}
+    iterator end() {return iterator(this, cap);}
+    const_iterator cbegin() const {return const_iterator(this, next_full(0));}
+    const_iterator cend() const {return const_iterator(this, cap);}
+
+    private:
+    swiss::ctrl_t* ctrl;
+    value_type* slots;
+    size_t cap;     // number of slots, a power of two and a multiple of the group width
+    size_t count;   // full slots
+    size_t used;    // full and deleted slots
+    H hash;
+    C comp;
+
+    static const size_t prefetch_distance = 8;  // keys between a prefetch and its probe in find_many
+
+    /* the low 7 bits feed the control byte and the rest pick the starting group */
+    template <class Key>
+    size_t hash_of(const Key& key) {return hash(key);}
+    static swiss::ctrl_t h2(size_t h) {return (swiss::ctrl_t)(h & 0x7F);}
+    static size_t h1(size_t h) {return h >> 7;}
+
+    /* Groups are probed with a triangular sequence, which visits every group once
+     * when the number of groups is a power of two. Returns cap if the key is absent. */
+    template <class Key>
+    size_t find_index(const Key& key, size_t h) const {
+        if (cap == 0) return cap;
+        size_t mask = cap / swiss::kGroupWidth - 1;
+        size_t group = h1(h) & mask;
+        for (size_t step = 1; ; ++step) {
+            const swiss::ctrl_t* g = ctrl + group * swiss::kGroupWidth;
+            swiss::Group grp(g);
+            for (unsigned m = grp.match(h2(h)); m; m &= m - 1) {
+                size_t index = group * swiss::kGroupWidth + swiss::lowest_bit(m);
+                if (comp(slots[index].first, key))
+                    return index;
+            }
+            if (grp.match_empty() || step > mask)
+                return cap;
+            group = (group + step) & mask;
+        }
+    }
+    template <class Key>
+    void erase_key(const Key& val) {
+        size_t index = find_index(val, hash_of(val));
+        if (index == cap) return;
+        slots[index].~value_type();
+        --count;
+        // a probe only stops at a group with an empty slot, so the slot can only become empty again
+        // if its group still has one; otherwise leave a tombstone to keep later probes going
+        size_t group = index & ~(swiss::kGroupWidth-1);
+        if (swiss::Group(ctrl + group).match_empty()) {
+            ctrl[index] = swiss::kEmpty;
+            --used;
+        }
+        else
+            ctrl[index] = swiss::kDeleted;
+    }
+    template <class Key>
+    value_type* find_key(const Key& val) {
+        size_t index = find_index(val, hash_of(val));
+        return (index == cap)? NULL: &slots[index];
+    }
+    template <class Key>
+    void find_many_keys(const Key* keys, size_t n, value_type** out) {
+        if (cap == 0) {
+            for (size_t i = 0; i < n; ++i) out[i] = NULL;
+            return;
+        }
+        const size_t D = prefetch_distance;
+        size_t mask = cap / swiss::kGroupWidth - 1;
+        size_t h[prefetch_distance];
+        for (size_t i = 0; i < n + D; ++i) {
+            if (i >= D) {
+                size_t j = i - D, index = find_index(keys[j], h[j % D]);
+                out[j] = (index == cap)? NULL: &slots[index];
+            }
+            if (i < n) {
+                size_t x = h[i % D] = hash_of(keys[i]);
+                size_t group = (h1(x) & mask) * swiss::kGroupWidth;
+                my::prefetch(ctrl + group);
+                my::prefetch(slots + group);
+            }
+        }
+    }
+    template <class Key>
+    V& at_key(const Key& val) {
+        value_type* p = find_key(val);
+        if (p == NULL) throw std::out_of_range("swiss_map::at() Key not found!");
+        return p->second;
+    }
+    template <class InputIterator>
+    void insert_range(InputIterator first, InputIterator last, std::input_iterator_tag) {
+        for (; first != last; ++first)
+            insert(*first);
+    }
+    template <class ForwardIterator>
+    void insert_range(ForwardIterator first, ForwardIterator last, std::forward_iterator_tag) {
+        size_t n = 0;
+        for (ForwardIterator it = first; it != last; ++it)
+            ++n;
+        reserve(count + n);
+        for (; first != last; ++first)
+            insert(*first);
+    }
+    size_t find_free(size_t h) const {
+        size_t mask = cap / swiss::kGroupWidth - 1;
+        size_t group = h1(h) & mask;
+        for (size_t step = 1; ; ++step) {
+            unsigned m = swiss::Group(ctrl + group * swiss::kGroupWidth).match_empty_or_deleted();
+            if (m)
+                return group * swiss::kGroupWidth + swiss::lowest_bit(m);
+            group = (group + step) & mask;
+        }
+    }
+    /* Finds a slot for a key known to be absent, growing first if needed. The caller constructs
+     * the value in it and then calls publish, so a constructor that throws leaves no half-full slot. */
+    size_t prepare_insert(size_t h) {
+        if (used + 1 > cap - cap/8) {
+            // mostly tombstones: rehash in place, otherwise double
+            if (cap != 0 && count + 1 <= (cap - cap/8) / 2)
+                rehash(cap);
+            else
+                rehash(cap == 0? swiss::kGroupWidth: cap * 2);
+        }
+        return find_free(h);
+    }
+    void publish(size_t index, size_t h) {
+        if (ctrl[index] == swiss::kEmpty) ++used;
+        ctrl[index] = h2(h);
+        ++count;
+    }
+    #if __cplusplus >= 201103L
+    template <class Key, class... Args>
+    std::pair<value_type*, bool> emplace_key(Key&& key, Args&&... args) {
+        size_t h = hash_of(key);
+        size_t index = find_index(key, h);
+        if (index != cap)
+            return std::pair<value_type*, bool>(&slots[index], false);
+        index = prepare_insert(h);
+        new (&slots[index]) value_type(std::piecewise_construct,
+            std::forward_as_tuple(std::forward<Key>(key)), std::forward_as_tuple(std::forward<Args>(args)...));
+        publish(index, h);
+        return std::pair<value_type*, bool>(&slots[index], true);
+    }
+    template <class Key, class M>
+    std::pair<value_type*, bool> assign_key(Key&& key, M&& obj) {
+        size_t h = hash_of(key);
+        size_t index = find_index(key, h);
+        if (index != cap) {
+            slots[index].second = std::forward<M>(obj);
+            return std::pair<value_type*, bool>(&slots[index], false);
+        }
+        index = prepare_insert(h);
+        new (&slots[index]) value_type(std::forward<Key>(key), std::forward<M>(obj));
+        publish(index, h);
+        return std::pair<value_type*, bool>(&slots[index], true);
+    }
+    #endif
+    void rehash(size_t n) {
+        swiss::ctrl_t* old_ctrl = ctrl;
+        value_type* old_slots = slots;
+        size_t old_cap = cap;
+        // both blocks are allocated before the map is touched, so bad_alloc leaves it as it was
+        swiss::ctrl_t* new_ctrl = new swiss::ctrl_t[n];
+        try {
+            slots = static_cast<value_type*>(::operator new(n * sizeof(value_type)));
+        }
+        catch (...) {
+            delete [] new_ctrl;
+            throw;
+        }
+        ctrl = new_ctrl;
+        cap = n;
+        for (size_t i = 0; i < n; ++i)
+            ctrl[i] = swiss::kEmpty;
+        used = count;
+        for (size_t i = 0; i < old_cap; ++i) {
+            if (old_ctrl[i] >= 0) {
+                size_t h = hash_of(old_slots[i].first);
+                size_t index = find_free(h);
+                ctrl[index] = h2(h);
+            #if __cplusplus >= 201103L
+                new (&slots[index]) value_type(std::move(old_slots[i]));
+            #else
+                new (&slots[index]) value_type(old_slots[i]);
+            #endif
+                old_slots[i].~value_type();
+            }
+        }
+        delete [] old_ctrl;
+        ::operator delete(old_slots);
+    }
+    void deallocate() {
+        delete [] ctrl;
+        ::operator delete(slots);
+        ctrl = NULL; slots = NULL; cap = 0;
+    }
+    /* scans a whole control group per step instead of one byte at a time */
+    size_t next_full(size_t i) const {
+        while (i < cap) {
+            size_t group = i & ~(swiss::kGroupWidth-1);
+            unsigned m = swiss::Group(ctrl + group).match_full() & (~0u << (i - group));
+            if (m)
+                return group + swiss::lowest_bit(m);
+            i = group + swiss::kGroupWidth;
+        }
+        return cap;
+    }
+    void copy(const swiss_map& m) {
+        for (size_t i = 0; i < m.cap; ++i)
+            if (m.ctrl[i] >= 0)
+                insert(m.slots[i]);
+    }
+};
+
+#endif
@@ -1,6 +1,27 @@
 #ifndef UTILITIES_H
 #define UTILITIES_H
 
+#include <cstddef>
+#include <iterator>
+#if __cplusplus >= 201103L
+#include <type_traits>
+#include <utility>
+#endif
+#if __cplusplus >= 201703L
+#include <string>
+#include <string_view>
+#endif
+
+/* An empty member, e.g. a stateless allocator, takes no space (C++20, or as an extension). */
+#if __cplusplus >= 201103L && defined(__has_cpp_attribute)
+#if __has_cpp_attribute(no_unique_address)
+#define MY_NO_UNIQUE_ADDRESS [[no_unique_address]]
+#endif
+#endif
+#ifndef MY_NO_UNIQUE_ADDRESS
+#define MY_NO_UNIQUE_ADDRESS
+#endif
+
 namespace my {
     int strcmp(const char* lhs, const char* rhs) {
         size_t i;
@@ -42,8 +63,94 @@ namespace my {
             return strcmp(lhs, rhs) == 0;
         }
     };
+    #if __cplusplus >= 201703L
+    template <> struct equals <std::string> {
+        typedef void is_transparent;
+        bool operator()(std::string_view lhs, std::string_view rhs) const {
+            return lhs == rhs;
+        }
+    };
+    #endif
+    /*----------index of the lowest set bit, x must not be 0----------*/
+    inline unsigned ctz(unsigned long long x) {
+    #if defined(__GNUC__) || defined(__clang__)
+        return __builtin_ctzll(x);
+    #else
+        unsigned i = 0;
+        while (!(x & 1)) {x >>= 1; ++i;}
+        return i;
+    #endif
+    }
+    /*----------hint that p will be read soon, a no-op where unsupported----------*/
+    inline void prefetch(const void* p) {
+    #if defined(__GNUC__) || defined(__clang__)
+        __builtin_prefetch(p);
+    #else
+        (void)p;
+    #endif
+    }
+    /*----------a T that can be moved to new memory by copying its bytes, e.g. with realloc----------*/
+    // specialize for your own types that hold no pointers into themselves
+    template <class T> struct is_trivially_relocatable {
+    #if __cplusplus >= 201103L
+        static const bool value = std::is_trivially_copyable<T>::value;
+    #else
+        static const bool value = false;
+    #endif
+    };
+    /*----------whether T is an integer, to tell (n, val) arguments from a (first, last) range----------*/
+    template <class T> struct is_integer {
+    #if __cplusplus >= 201103L
+        static const bool value = std::is_integral<T>::value;
+    #else
+        static const bool value = false;
+    #endif
+    };
+    #if __cplusplus < 201103L
+    template <> struct is_integer<bool> {static const bool value = true;};
+    template <> struct is_integer<char> {static const bool value = true;};
+    template <> struct is_integer<signed char> {static const bool value = true;};
+    template <> struct is_integer<unsigned char> {static const bool value = true;};
+    template <> struct is_integer<wchar_t> {static const bool value = true;};
+    template <> struct is_integer<short> {static const bool value = true;};
+    template <> struct is_integer<unsigned short> {static const bool value = true;};
+    template <> struct is_integer<int> {static const bool value = true;};
+    template <> struct is_integer<unsigned int> {static const bool value = true;};
+    template <> struct is_integer<long> {static const bool value = true;};
+    template <> struct is_integer<unsigned long> {static const bool value = true;};
+    template <> struct is_integer<long long> {static const bool value = true;};
+    template <> struct is_integer<unsigned long long> {static const bool value = true;};
+    #endif
+    template <bool B> struct bool_constant {};
+    /*----------number of elements in [first, last), in O(1) for random access iterators----------*/
+    template <class InputIterator>
+    size_t distance(InputIterator first, InputIterator& last, std::random_access_iterator_tag) {
+        return last - first;
+    }
+    template <class InputIterator>
+    size_t distance(InputIterator first, InputIterator& last, typename std::iterator_traits<InputIterator>::iterator_category) {
+        size_t n = 0;
+        for (; first != last; ++first)
+            n++;
+        return n;
+    }
+    /*----------whether [first1, last1) sorts before [first2, last2) element by element----------*/
+    template <class InputIterator1, class InputIterator2>
+      bool lexicographicalCompare (InputIterator1 first1, InputIterator1 last1,
+                                    InputIterator2 first2, InputIterator2 last2) {
+        while (first1!=last1) {
+            if (first2==last2 || *first2<*first1) return false;
+            else if (*first1<*first2) return true;
+            ++first1; ++first2;
+        }
+        return (first2!=last2);
+    }
     template <class T> void swap(T& a, T& b) {
+    #if __cplusplus >= 201103L
+        T temp = std::move(a); a = std::move(b); b = std::move(temp);
+    #else
         T temp = a; a = b; b = temp;
+    #endif
     }
 }
 
@@ -2,501 +2,162 @@
 #define VECTOR_H
 
 #include <iostream>
+#include <iterator>
+#include <cstddef>
 #include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <new>
 #include "utilities.h"
+#include "allocator.h"
+#include "vectorbase.h"
 
 namespace my {
-    template <class T> class vector;
-    template<class T> std::ostream& operator<< ( std::ostream& os, const vector<T>& v);
-}
-template <class T>
-class my::vector {
-    friend std::ostream& operator<< <> (std::ostream& os, const vector& v);
+    template <class T, class A = malloc_allocator<T> > class vector;
+}
+/*
+ * Memory comes from A, by default my::malloc_allocator<T>, with which a trivially relocatable T
+ * grows by realloc. With my::polymorphic_allocator<T> the vector allocates from any
+ * my::memory_resource, e.g. a monotonic arena that frees nothing until it is released; see
+ * allocator.h. An empty allocator takes no space in the vector (with C++11).
+ * Everything but the allocation is my::vector_base, see vectorbase.h.
+ */
+template <class T, class A>
+class my::vector: public my::vector_base<T, my::vector<T, A> > {
+    friend class vector_base<T, vector>;
+    typedef vector_base<T, vector> base;
+    using base::arr;
+    using base::inUse;
+    using base::allocated;
     public:
-    template <class U> class vector_iterator {
-        public:
-        typedef U value_type;
-        typedef U& reference;
-        typedef U* pointer;
-        typedef std::random_access_iterator_tag iterator_category;
-        typedef size_t difference_type;
-        vector_iterator(size_t p = 0, const vector* t = NULL): ptr(p), v(t) {}
-        vector_iterator& operator=(const vector_iterator& it) {ptr = it.ptr; v = it.v; return *this;} 
-        vector_iterator& operator+=(int n) {ptr += n; return *this;}
-        vector_iterator& operator++() {ptr++; return *this;}
-        vector_iterator operator++(int) {vector_iterator it = *this; ++*this; return it;}
-        vector_iterator operator+(int n) {return vector_iterator(ptr+n, v);}
-        friend vector_iterator operator+(int n, vector_iterator& it) {return vector_iterator(it.ptr+n, it.v);}
-        vector_iterator& operator-=(int n) {ptr -= n; return *this;}
-        vector_iterator& operator--() {ptr--; return *this;}
-        vector_iterator operator-(int n) {return vector_iterator(ptr-n, v);}
-        vector_iterator operator--(int) {vector_iterator it = *this; --*this; return it;}
-        difference_type operator-(const vector_iterator& it) {return ptr - it.ptr;}
-        bool operator<(const vector_iterator& it) {return ptr < it.ptr;}
-        bool operator<=(const vector_iterator& it) {return ptr <= it.ptr;}
-        bool operator>(const vector_iterator& it) {return ptr > it.ptr;}
-        bool operator>=(const vector_iterator& it) {return ptr >= it.ptr;}
-        bool operator==(const vector_iterator& it) {return ptr == it.ptr;}
-        bool operator!=(const vector_iterator& it) {return ptr != it.ptr;}
-        reference operator*() {return v->arr[ptr];}
-        reference operator[](int n) {return v->arr[ptr+n];}
-        pointer operator->() {return v->arr[ptr];}
-
-        private:
-        size_t ptr;
-        const vector* v;
-    };
-    typedef size_t size_type;
-    typedef T value_type;
-    typedef vector_iterator<T> iterator;
-    typedef vector_iterator<const T> const_iterator;
-    typedef std::reverse_iterator<iterator> reverse_iterator;
-    typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+    #if __cplusplus >= 201103L
+    typedef typename std::allocator_traits<A>::template rebind_alloc<T> allocator_type;
+    #else
+    typedef typename A::template rebind<T>::other allocator_type;
+    #endif
 
-    explicit vector();
-    explicit vector(size_t n);
-    vector(size_t n, const T& val);
+    explicit vector(const A& a = A()): alloc(a) {}
+    explicit vector(size_t n, const A& a = A());
+    vector(size_t n, const T& val, const A& a = A());
     template<class InputIterator>
-    vector(InputIterator begin, InputIterator end);
+    vector(InputIterator begin, InputIterator end, const A& a = A()): alloc(a) {this->assign(begin, end);}
     vector(const vector& vec);
-    ~vector() {free(arr);}
+    vector(const vector& vec, const A& a);
+    ~vector() {base::destroy(arr, arr+inUse); deallocate(arr, allocated);}
     vector& operator=(const vector& vec);
-    void assign(size_t n, const T& val);
-    template<class InputIterator>
-    void assign(InputIterator begin, InputIterator end);
-    T& at(size_t val) const;
-    T& operator[](int val) const {return this->at(val);}
-    T& front () const;
-    T& back() const;
-    T* data() const {return arr;}
-    void push_back(const T& val);
-    void pop_back();
-    template<class InputIterator>
-    void copy(InputIterator begin, InputIterator end);
-    iterator insert(iterator it, const T& val, size_t n = 1);
-    template<class InputIterator>
-    void insert(iterator it, InputIterator begin, InputIterator end);
-    void erase(iterator it);
-    void erase(iterator begin, iterator end);
-    void eraseAll(const T& val);
-    bool empty() const {return inUse == 0;}
-    size_t size() const {return inUse;}
-    size_t capacity() const {return allocated;}
-    void resize(size_t v, const T& val);
-    void resize(size_t v) {resize(v, T());}
-    void reserve(size_t v);
-    void shrink_to_fit();
-    void swap(vector& vec);
-    void clear();
-    void sort() {quickSort(0, size()-1, my::less<T>());}
-    template <class C>
-    void sort(C compare) {quickSort(0, size()-1, compare);}
-    iterator find(iterator begin, iterator end, const T& val) const;
-    iterator find_s(iterator begin, iterator end, const T& val) const;  //uses binary search
-    iterator begin() const {return iterator(0, this);}
-    iterator end() const {return iterator(inUse, this);}
-    const_iterator cbegin() const {return const_iterator(0, this);}
-    const_iterator cend() const {return const_iterator(inUse, this);}
-    reverse_iterator rbegin() const {return reverse_iterator(end());}
-    reverse_iterator rend() const {return reverse_iterator(begin());}
-    const_reverse_iterator crbegin() const 
-    {return const_reverse_iterator(cend());}
-    const_reverse_iterator crend() const
-    {return const_reverse_iterator(cbegin());}
+    allocator_type get_allocator() const {return alloc;}
+    void swap(vector& vec) {this->swap_storage(vec); my::swap(alloc, vec.alloc);}
 
     #if __cplusplus >= 201103L
-    vector(std::initializer_list<T> l);
+    vector(std::initializer_list<T> l, const A& a = A());
     vector(vector&& v);
+    vector(vector&& v, const A& a);
     vector& operator=(std::initializer_list<T> l);
     vector& operator=(vector&& v);
-    void insert(iterator it, std::initializer_list<T> l);
-    template <class... Args>
-    iterator emplace(const_iterator it, Args&&... args)
-    {return insert(it, T(args...));}
-    template <class... Args>
-    void emplace_back(Args&&... args) {push_back(T(args...));}
     #endif
 
     private:
-    T* arr;
-    size_t inUse;
-    size_t allocated;
+    MY_NO_UNIQUE_ADDRESS allocator_type alloc;
 
-    void growArray(size_t n);
-    template <class C>
-    size_t partition(size_t l, size_t h, const C& comp);
-    template <class C>
-    void quickSort(size_t low, size_t high, const C& comp);
+    static const char* name() {return "vector";}
+    T* allocate(size_t& n) {return (n == 0)? NULL: alloc.allocate(n);}
+    void deallocate(T* p, size_t n) {if (p != NULL) alloc.deallocate(p, n);}
+    /* only a malloc'd block can be handed to realloc, see my::realloc_with */
+    T* try_realloc(size_t n) {return my::realloc_with(alloc, arr, allocated, n);}
+    void take(vector& v) {
+        arr = v.arr; inUse = v.inUse; allocated = v.allocated;
+        v.arr = NULL; v.inUse = 0; v.allocated = 0;
+    }
+    static allocator_type copy_allocator(const allocator_type& a) {
+    #if __cplusplus >= 201103L
+        return std::allocator_traits<allocator_type>::select_on_container_copy_construction(a);
+    #else
+        return a;
+    #endif
+    }
 };
 
 #if __cplusplus >= 201103L
-template <class T>
-my::vector<T>::vector(std::initializer_list<T> l): allocated(l.size()) {
-    arr = (T*)malloc(sizeof(T)*allocated);
-    auto it = l.begin();
-    for (size_t i = 0; i < allocated; ++i)
-        arr[i] = *it++;
-    inUse = allocated;
+template <class T, class A>
+my::vector<T, A>::vector(std::initializer_list<T> l, const A& a): alloc(a) {
+    this->reserve(l.size());
+    this->copy(l.begin(), l.end());
 }
-template <class T>
-my::vector<T>::vector(vector&& v) {
-    allocated = v.allocated; v.allocated = 0;
-    inUse = v.inuse; v.inUse = 0;
-    arr = v.arr; v.arr = NULL;
+template <class T, class A>
+my::vector<T, A>::vector(vector&& v): alloc(std::move(v.alloc)) {
+    take(v);
 }
-template <class T>
-my::vector<T>& my::vector<T>::operator=(vector&& v) {
-    if (this != &v) {
-        free(arr);
-        allocated = v.allocated; v.allocated = 0;
-        inUse = v.inuse; v.inUse = 0;
-        arr = v.arr; v.arr = NULL;
+/* The block can only be taken over if this vector's allocator can free it; otherwise the
+ * elements are moved one by one into memory from a. */
+template <class T, class A>
+my::vector<T, A>::vector(vector&& v, const A& a): alloc(a) {
+    if (alloc == v.alloc) {
+        take(v);
+        return;
     }
+    this->reserve(v.inUse);
+    for (; inUse < v.inUse; inUse++)
+        new (arr+inUse) T(std::move(v.arr[inUse]));
+    v.clear();
+}
+/* keeps this vector's allocator, as std::pmr containers do */
+template <class T, class A>
+my::vector<T, A>& my::vector<T, A>::operator=(vector&& v) {
+    if (this == &v)
+        return *this;
+    if (alloc == v.alloc) {
+        base::destroy(arr, arr+inUse);
+        deallocate(arr, allocated);
+        take(v);
+        return *this;
+    }
+    this->clear();
+    this->reserve(v.inUse);
+    for (; inUse < v.inUse; inUse++)
+        new (arr+inUse) T(std::move(v.arr[inUse]));
+    v.clear();
     return *this;
 }
-template <class T>
-my::vector<T>& my::vector<T>::operator= (std::initializer_list<T> l) {
-    clear();
+template <class T, class A>
+my::vector<T, A>& my::vector<T, A>::operator= (std::initializer_list<T> l) {
+    this->clear();
     this->copy(l.begin(), l.end());
     return *this;
 }
-template <class T>
-void my::vector<T>::insert(iterator it, std::initializer_list<T> l) {
-    size_t n = l.size();
-    size_t first = it - this->begin();
-    size_t last = first + n - 1;
-    this->resize(inUse+n);
-    size_t i;
-    for (i = inUse-1; i > last; i--)
-        arr[i] = arr[i-n];
-    auto iter = l.begin();
-    for (i = first; i <= last; i++) {
-        arr[i] = *iter;
-        ++iter;
-    }
-}
 #endif
 
-template <class T> template<class InputIterator>
-void my::vector<T>::copy(InputIterator begin, InputIterator end) {
-    while (begin != end) {
-        this->push_back(*begin);
-        ++begin;
+template <class T, class A>
+my::vector<T, A>::vector(size_t n, const A& a): alloc(a) {
+    this->reserve(n);
+    for (; inUse < n; inUse++)
+        new (arr+inUse) T();
+}
+template <class T, class A>
+my::vector<T, A>::vector(size_t n, const T& val, const A& a): alloc(a) {
+    this->reserve(n);
+    for (; inUse < n; inUse++)
+        new (arr+inUse) T(val);
+}
+template <class T, class A>
+my::vector<T, A>::vector(const vector& vec): base(), alloc(copy_allocator(vec.alloc)) {
+    this->reserve(vec.size());
+    for (; inUse < vec.inUse; inUse++)
+        new (arr+inUse) T(vec.arr[inUse]);
+}
+template <class T, class A>
+my::vector<T, A>::vector(const vector& vec, const A& a): base(), alloc(a) {
+    this->reserve(vec.size());
+    for (; inUse < vec.inUse; inUse++)
+        new (arr+inUse) T(vec.arr[inUse]);
+}
+template <class T, class A>
+my::vector<T, A>& my::vector<T, A>::operator=(const vector& vec) {
+    if (this != &vec) {
+        this->clear();
+        this->reserve(vec.size());
+        this->copy(vec.begin(), vec.end());
     }
-}
-template <class T>
-my::vector<T>::vector(): arr(NULL), inUse(0), allocated(0) {}
-
-template <class T>
-my::vector<T>::vector(size_t n): inUse(n), allocated(n) {
-    arr = (T*)malloc(sizeof(T)*allocated);
-    for (size_t i = 0; i < n; i++)
-        arr[i] = T();
-}
-template <class T>
-my::vector<T>::vector(size_t n, const T& val): inUse(n), allocated(n) {
-    arr = (T*)malloc(sizeof(T)*allocated);
-    for (size_t i = 0; i < n; i++)
-        arr[i] = val;
-}
-template <class T> template<class InputIterator>
-my::vector<T>::vector(InputIterator begin, InputIterator end): arr(NULL), inUse(0), allocated(0) {
-    this->copy(begin, end);
-}
-template <class T>
-my::vector<T>::vector(const vector& vec): allocated(vec.size()) {
-    arr = (T*)malloc(sizeof(T)*allocated);
-    for (size_t i = 0; i < allocated; i++) {
-        arr[i] = vec.arr[i];
-    }
-    inUse = allocated;
-}
-template <class T>
-my::vector<T>& my::vector<T>::operator=(const vector& vec) {
-    clear();
-    this->copy(vec.begin(), vec.end());
     return *this;
 }
-template <class T>
-void my::vector<T>::assign(size_t n, const T& val) {
-    clear();
-    inUse = allocated = n;
-    arr = (T*)malloc(sizeof(T)*allocated);
-    for (size_t i = 0; i < inUse; i++)
-        arr[i] = val;
-}
-template <class T> template<class InputIterator>
-void my::vector<T>::assign(InputIterator begin, InputIterator end) {
-    clear();
-    copy(begin, end);
-}
-template <class T>
-T& my::vector<T>::at(size_t val) const {
-     try {
-        if (val >= inUse) throw val;
-    }
-    catch (size_t i) {
-        std::cout << "Error in my::vector::range_check: index " << i << " is out of range\nthis->size() is " << inUse << "\n";
-        _Exit (EXIT_FAILURE);
-    }
-    return arr[val];
-}
-template <class T>
-T& my::vector<T>::front() const {
-    try {
-        if (inUse == 0) throw "Error in my::vector::range_check in call to my::vector::front()\n String is empty.\n";
-    }
-    catch (const char* s) {
-        std::cout << s;
-        _Exit (EXIT_FAILURE);
-    }
-    return arr[0];
-}
-template <class T>
-T& my::vector<T>::back() const {
-    try {
-        if (inUse == 0) throw "Error in my::vector::range_check in call to my::vector::back()\n String is empty.\n";
-    }
-    catch (const char* s) {
-        std::cout << s;
-        _Exit (EXIT_FAILURE);
-    }
-    return arr[inUse-1];
-}
-template <class T>
-void my::vector<T>::growArray(size_t n) {
-    if (n < 2) n = 2;
-    T* temp = arr;
-    allocated += n;
-    arr = (T*)malloc(sizeof(T)*allocated);
-    for (size_t i = 0; i < inUse; i++)
-        arr[i] = temp[i];
-    free(temp);
-}
-template <class T>
-void my::vector<T>::resize(size_t v, const T& val) {
-    size_t i(0);
-    if (v < inUse) {
-        T* temp = arr;
-        allocated = v;
-        arr = (T*)malloc(sizeof(T)*allocated);
-        for (; i < v; i++) {
-            arr[i] = temp[i];
-        }
-        free(temp);
-    }
-    this->reserve(v);
-    if (v > inUse) {
-        for (i = inUse; i < v; i++)
-            arr[i] = val;
-    }
-    inUse = v;
-}
-template <class T>
-void my::vector<T>::reserve(size_t v) {
-    if (v > allocated)
-        growArray(v-allocated);
-}
-template <class T>
-void my::vector<T>::push_back(const T& val) {
-    if (inUse == allocated)
-        growArray(allocated);
-    arr[inUse++] = val;
-}
-template <class T>
-void my::vector<T>::pop_back() {
-    --inUse;
-    if (inUse == 0)
-        clear();
-}
-template <class T>
-void my::vector<T>::shrink_to_fit() {
-    T* temp = arr;
-    allocated = inUse;
-    arr = (T*)malloc(sizeof(T)*allocated);
-    for (int i = 0; i < inUse; i++)
-        arr[i] = temp[i];
-    free(temp);
-}
-template <class T>
-void my::vector<T>::swap(vector& vec) {
-    T* t_arr = vec.arr; vec.arr = this->arr; this->arr = t_arr;
-    size_t t_inUse = vec.inUse; vec.inUse = this->inUse; this->inUse = t_inUse;
-    size_t t_alloc = vec.allocated; vec.allocated = this->allocated; this->allocated = t_alloc;
-}
-template <class T>
-void my::vector<T>::clear() {
-    free(arr);
-    arr = NULL; inUse = 0; allocated = 0;
-}
-template <class T> class my::vector<T>::
-vector_iterator<T> my::vector<T>::insert(iterator it, const T& val, size_t n) {
-    size_t begin = it - this->begin();
-    size_t end = begin + n - 1;
-    this->resize(inUse+n);
-    size_t i;
-    for (i = inUse-1; i > end; i--)
-        arr[i] = arr[i-n];
-    for (; i >= begin; i--)
-        arr[i] = val;
-    return iterator(arr+begin);
-}
-template <class InputIterator>
-size_t distance(InputIterator first, InputIterator& last, std::random_access_iterator_tag) {
-    return last - first;
-}
-template <class InputIterator>
-size_t distance(InputIterator first, InputIterator& last, typename std::iterator_traits<InputIterator>::iterator_category) {
-    size_t n = 0;
-    for (; first != last; ++first)
-        n++;
-    return n;
-}
-template <class T> template<class InputIterator>
-void my::vector<T>::insert(iterator it, InputIterator begin, InputIterator end) {
-    size_t n = distance(begin, end, typename std::iterator_traits<InputIterator>::iterator_category());
-    size_t first = it - this->begin();
-    size_t last = first + n - 1;
-    this->resize(inUse+n);
-    size_t i;
-    for (i = inUse-1; i > last; i--)
-        arr[i] = arr[i-n];
-    for (i = first; i <= last; i++) {
-        arr[i] = *begin;
-        ++begin;
-    }
-}
-template <class T>
-void my::vector<T>::erase(iterator it) {
-    if (inUse == 0)
-        return;
-    for (size_t i = it - this->begin(); i < inUse-1; i++)
-        arr[i] = arr[i+1];
-    this->pop_back();
-}
-template <class T>
-void my::vector<T>::erase(iterator begin, iterator end) {
-    if (inUse == 0)
-        return;
-    size_t n = end - begin;
-    for (size_t i = begin.index; i < inUse-n; i++)
-        arr[i] = arr[i+n];
-    this->resize(inUse-n);
-}
-template <class T>
-void my::vector<T>::eraseAll(const T& val) {
-    if (inUse == 0)
-        return;
-    size_t i = 0;
-    for (size_t j = 0; j < inUse; j++) {
-        if (arr[j] != val)
-            arr[i++] = arr[j];
-    }
-    this->resize(i);
-}
-template <class T> template <class C>
-size_t my::vector<T>::partition(size_t l, size_t h, const C& comp) {
-    bool done = false;
-   
-    // Pick middle element as pivot
-    size_t midpoint = l + (h - l) / 2;
-    T pivot = arr[midpoint];
-    while (!done) {
-        // Increment l while arr[l] < pivot
-        while (comp(arr[l], pivot)) ++l;
-        // Decrement h while pivot < arr[h]
-        while (comp(pivot, arr[h])) --h;
-        // If there are zero or one elements remaining, all numbers are partitioned. Return h
-        if (l >= h)
-            done = true;
-        else {
-            // Swap arr[l] and arr[h], update l and high
-            my::swap(arr[l], arr[h]);
-            ++l; --h;
-        }
-    }
-    return h;
-}
-template <class T> template <class C>
-void my::vector<T>::quickSort(size_t l, size_t h, const C& comp) {
-    if (l >= h)
-        return;
-    size_t m = partition(l, h, comp);
-    quickSort(l, m, comp);
-    quickSort(m + 1, h, comp);
-}
-template <class T> class my::vector<T>::
-vector_iterator<T> my::vector<T>::find(iterator begin, iterator end, const T& val) const {
-    size_t start = begin - this->begin(), stop = end - this->begin();
-    for (; start < stop; start++) {
-        if (arr[start] == val)
-            break;
-    }
-    iterator it(arr+start, this);
-    return it;
-}
-template <class T> class my::vector<T>::
-vector_iterator<T> my::vector<T>::find_s(iterator begin, iterator end, const T& val) const {
-    size_t mid, low(begin - this->begin()), high((end - this->begin())- 1);
-
-    while (high >= low) {
-        mid = low + (high - low) / 2;
-        if (arr[mid] < val)
-            low = mid + 1;
-        else if (val < arr[mid])
-            high = mid - 1;
-        else
-            return iterator(mid, this);
-    }
-    return end; // not found
-}
-template<class T>
-std::ostream& my::operator << ( std::ostream& os, const my::vector<T>& v ) {
-    os << "[ ";
-    for (int i = 0; i < v.size(); i++)
-        os << v.[i] << " ";
-    os << "]" << std::endl;
-    return os;
-}
-template <class InputIterator1, class InputIterator2>
-  bool lexicographicalCompare (InputIterator1 first1, InputIterator1 last1,
-                                InputIterator2 first2, InputIterator2 last2) {
-    while (first1!=last1) {
-        if (first2==last2 || *first2<*first1) return false;
-        else if (*first1<*first2) return true;
-        ++first1; ++first2;
-    }
-    return (first2!=last2);
-}
-template <class T>
-bool operator==(my::vector<T>& v1, my::vector<T>& v2) {
-    if (v1.size() != v2.size())
-        return false;
-    for (int i = 0; i < v1.size(); i++) {
-        if (v1[i] != v2[i])
-            return false;
-    }
-    return true;
-}
-template <class T>
-bool operator!=(my::vector<T>& v1, my::vector<T>& v2) {
-    return !(v1 == v2);
-}
-template <class T>
-bool operator<(my::vector<T>& v1, my::vector<T>& v2) {
-    return(lexicographicalCompare(v1.begin(), v1.end(), v2.begin(), v2.end()));
-}
-template <class T>
-bool operator<=(my::vector<T>& v1, my::vector<T>& v2) {
-    return (v1 == v2 || v1 < v2);
-}
-template <class T>
-bool operator>(my::vector<T>& v1, my::vector<T>& v2) {
-    return !(v1 == v2 || v1 < v2);
-}
-template <class T>
-bool operator>=(my::vector<T>& v1, my::vector<T>& v2) {
-    return !(v1 < v2);
-}
 
 #endif
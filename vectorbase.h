@@ -0,0 +1,606 @@
+#ifndef VECTORBASE_H
+#define VECTORBASE_H
+
+#include <iostream>
+#include <iterator>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <new>
+#include "utilities.h"
+#include "sort.h"
+#include "simd.h"
+#include "search.h"
+
+/* Define MY_VECTOR_HARDENED before including this header to have operator[], front() and back()
+ * check their index as at() does. Without it they compile to a plain array access; at() always checks. */
+#ifdef MY_VECTOR_HARDENED
+#define MY_VECTOR_CHECK(stmt) stmt
+#else
+#define MY_VECTOR_CHECK(stmt)
+#endif
+
+/*
+ * What my::vector and my::small_vector share. my::vector_base<T, Derived> keeps the elements in
+ * arr[0, inUse) of a block of allocated slots and implements the whole vector interface on them;
+ * Derived only says where blocks come from, through these private members (befriend the base):
+ *
+ *     T* allocate(size_t& n);           a block of at least n slots, n set to the slots it has
+ *     void deallocate(T* p, size_t n);  gives back a block from allocate
+ *     T* try_realloc(size_t n);         arr's block resized to n slots, bytes kept, or NULL if it can't
+ *     static const char* name();        for error messages, e.g. "vector"
+ *
+ * my::mmap_vector must write its file header on every change, so it only uses the helpers in detail.
+ */
+
+namespace my {
+    template <class T, class U> class vector_iterator;
+    template <class T, class Derived> class vector_base;
+    /*----------capacity is multiplied by num/den whenever a vector runs out of room----------*/
+    // specialize to change the factor for one element type, e.g. num = 3, den = 2
+    template <class T> struct vector_growth {
+        static const size_t num = 2;
+        static const size_t den = 1;
+    };
+    template <class T, class D> std::ostream& operator<< ( std::ostream& os, const vector_base<T, D>& v);
+
+    namespace detail {
+        /* Geometric growth: allocated times vector_growth<T>, so n appends copy O(n) elements in
+         * total; at least allocated + least and at least needed. */
+        template <class T>
+        size_t next_capacity(size_t allocated, size_t needed, size_t least) {
+            size_t n = allocated / vector_growth<T>::den * vector_growth<T>::num
+                     + allocated % vector_growth<T>::den * vector_growth<T>::num / vector_growth<T>::den;
+            if (n < allocated + least) n = allocated + least;
+            return (n < needed)? needed: n;
+        }
+        /* the element of the sorted range [first, last) equal to val, or last */
+        template <class P, class T>
+        P find_sorted(P first, P last, const T& val) {
+            P p = my::lower_bound(first, last, val);
+            return (p != last && !(val < *p))? p: last;
+        }
+        template <class T>
+        void move_assign(T& to, T& from) {
+        #if __cplusplus >= 201103L
+            to = std::move(from);
+        #else
+            to = from;
+        #endif
+        }
+        /* moves the elements pred rejects to the front, in order, and returns their end */
+        template <class T, class Predicate>
+        T* remove_if(T* first, T* last, Predicate pred) {
+            T* out = first;
+            for (; first != last; ++first) {
+                if (!pred(*first)) {
+                    if (out != first) move_assign(*out, *first);
+                    ++out;
+                }
+            }
+            return out;
+        }
+        /* the error paths of the checks, kept out of the inline accessors */
+        inline void vector_range_error(const char* name, size_t val, size_t size) {
+            std::cerr << "Error in my::" << name << "::range_check: index " << val << " is out of range\nthis->size() is " << size << "\n";
+            _Exit (EXIT_FAILURE);
+        }
+        inline void vector_empty_error(const char* name, const char* caller) {
+            std::cerr << "Error in my::" << name << "::range_check in call to my::" << name << "::" << caller << "()\n Vector is empty.\n";
+            _Exit (EXIT_FAILURE);
+        }
+    }
+}
+
+/* A pointer into a vector and nothing else, so loops over begin()/end() compile to plain pointer
+ * loops; U is T or const T. The elements are contiguous: with C++20 this is a std::contiguous_iterator. */
+template <class T, class U>
+class my::vector_iterator {
+    public:
+    typedef T value_type;
+    typedef U& reference;
+    typedef U* pointer;
+    typedef std::random_access_iterator_tag iterator_category;
+    #if __cplusplus >= 202002L
+    typedef std::contiguous_iterator_tag iterator_concept;
+    #endif
+    typedef std::ptrdiff_t difference_type;
+    vector_iterator(U* p = NULL): ptr(p) {}
+    // an iterator converts to a const_iterator, not the other way round
+    vector_iterator(const vector_iterator<T, T>& it): ptr(it.base()) {}
+    vector_iterator& operator+=(difference_type n) {ptr += n; return *this;}
+    vector_iterator& operator++() {ptr++; return *this;}
+    vector_iterator operator++(int) {vector_iterator it = *this; ++ptr; return it;}
+    vector_iterator operator+(difference_type n) const {return vector_iterator(ptr+n);}
+    friend vector_iterator operator+(difference_type n, const vector_iterator& it) {return vector_iterator(it.ptr+n);}
+    vector_iterator& operator-=(difference_type n) {ptr -= n; return *this;}
+    vector_iterator& operator--() {ptr--; return *this;}
+    vector_iterator operator-(difference_type n) const {return vector_iterator(ptr-n);}
+    vector_iterator operator--(int) {vector_iterator it = *this; --ptr; return it;}
+    friend difference_type operator-(const vector_iterator& a, const vector_iterator& b) {return a.ptr - b.ptr;}
+    friend bool operator<(const vector_iterator& a, const vector_iterator& b) {return a.ptr < b.ptr;}
+    friend bool operator<=(const vector_iterator& a, const vector_iterator& b) {return a.ptr <= b.ptr;}
+    friend bool operator>(const vector_iterator& a, const vector_iterator& b) {return a.ptr > b.ptr;}
+    friend bool operator>=(const vector_iterator& a, const vector_iterator& b) {return a.ptr >= b.ptr;}
+    friend bool operator==(const vector_iterator& a, const vector_iterator& b) {return a.ptr == b.ptr;}
+    friend bool operator!=(const vector_iterator& a, const vector_iterator& b) {return a.ptr != b.ptr;}
+    reference operator*() const {return *ptr;}
+    reference operator[](difference_type n) const {return ptr[n];}
+    pointer operator->() const {return ptr;}
+    pointer base() const {return ptr;}
+
+    private:
+    U* ptr;
+};
+
+template <class T, class Derived>
+class my::vector_base {
+    public:
+    typedef size_t size_type;
+    typedef T value_type;
+    typedef vector_iterator<T, T> iterator;
+    typedef vector_iterator<T, const T> const_iterator;
+    typedef std::reverse_iterator<iterator> reverse_iterator;
+    typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+    void assign(size_t n, const T& val);
+    template<class InputIterator>
+    void assign(InputIterator begin, InputIterator end);
+    T& at(size_t val) const {check_index(val); return arr[val];}
+    T& operator[](size_t val) const {MY_VECTOR_CHECK(check_index(val);) return arr[val];}
+    T& front() const {MY_VECTOR_CHECK(check_nonempty("front");) return arr[0];}
+    T& back() const {MY_VECTOR_CHECK(check_nonempty("back");) return arr[inUse-1];}
+    T* data() const {return arr;}
+    void push_back(const T& val);
+    void pop_back() {arr[--inUse].~T();}
+    template<class InputIterator>
+    void copy(InputIterator begin, InputIterator end);
+    iterator insert(iterator it, const T& val, size_t n = 1);
+    template<class InputIterator>
+    void insert(iterator it, InputIterator begin, InputIterator end);
+    void erase(iterator it) {erase(it, it+1);}
+    void erase(iterator begin, iterator end);
+    void eraseAll(const T& val);
+    template <class Predicate>
+    void eraseIf(Predicate pred);
+    bool empty() const {return inUse == 0;}
+    size_t size() const {return inUse;}
+    size_t capacity() const {return allocated;}
+    void resize(size_t v, const T& val);
+    void resize(size_t v) {resize(v, T());}
+    void reserve(size_t v) {if (v > allocated) reallocate(v);}
+    void shrink_to_fit() {if (inUse < allocated) reallocate(inUse);}
+    /* keeps the capacity, as std::vector does; shrink_to_fit() releases it */
+    void clear() {destroy(arr, arr+inUse); inUse = 0;}
+    /* radix sorts large vectors of numbers, see sort.h */
+    void sort() {my::sort(arr, arr+inUse);}
+    template <class C>
+    void sort(C compare) {my::sort(arr, arr+inUse, compare);}
+    #if __cplusplus >= 201103L
+    /* sorts on up to threads threads (0: one per core); small vectors are sorted in place as by sort() */
+    void parallel_sort(unsigned threads = 0) {my::parallel_sort(arr, arr+inUse, my::less<T>(), threads);}
+    template <class C, class = typename std::enable_if<!std::is_integral<C>::value>::type>
+    void parallel_sort(C compare, unsigned threads = 0) {my::parallel_sort(arr, arr+inUse, compare, threads);}
+    /* stable, linear time sort by key(element), which must return an integer, float or double */
+    template <class KeyFn>
+    void sort_by_key(KeyFn key) {my::radix_sort(arr, arr+inUse, key);}
+    #endif
+    /* find, count and eraseAll compare many numbers per instruction where they can, see simd.h */
+    iterator find(iterator begin, iterator end, const T& val) const {return iterator(my::find(begin.base(), end.base(), val));}
+    const_iterator find(const_iterator begin, const_iterator end, const T& val) const
+    {return const_iterator(my::find(begin.base(), end.base(), val));}
+    size_t count(const_iterator begin, const_iterator end, const T& val) const {return my::count(begin.base(), end.base(), val);}
+    //uses branchless binary search, see search.h
+    iterator find_s(iterator begin, iterator end, const T& val) const
+    {return iterator(detail::find_sorted(begin.base(), end.base(), val));}
+    const_iterator find_s(const_iterator begin, const_iterator end, const T& val) const
+    {return const_iterator(detail::find_sorted(begin.base(), end.base(), val));}
+    iterator begin() {return iterator(arr);}
+    iterator end() {return iterator(arr+inUse);}
+    const_iterator begin() const {return const_iterator(arr);}
+    const_iterator end() const {return const_iterator(arr+inUse);}
+    const_iterator cbegin() const {return const_iterator(arr);}
+    const_iterator cend() const {return const_iterator(arr+inUse);}
+    reverse_iterator rbegin() {return reverse_iterator(end());}
+    reverse_iterator rend() {return reverse_iterator(begin());}
+    const_reverse_iterator rbegin() const {return const_reverse_iterator(end());}
+    const_reverse_iterator rend() const {return const_reverse_iterator(begin());}
+    const_reverse_iterator crbegin() const
+    {return const_reverse_iterator(cend());}
+    const_reverse_iterator crend() const
+    {return const_reverse_iterator(cbegin());}
+
+    #if __cplusplus >= 201103L
+    void insert(iterator it, std::initializer_list<T> l) {insert(it, l.begin(), l.end());}
+    void push_back(T&& val) {emplace_back(std::move(val));}
+    iterator insert(iterator it, T&& val);
+    template <class... Args>
+    iterator emplace(iterator it, Args&&... args)
+    {return insert(it, T(std::forward<Args>(args)...));}
+    template <class... Args>
+    void emplace_back(Args&&... args);
+    #endif
+
+    protected:
+    T* arr;
+    size_t inUse;
+    size_t allocated;
+
+    vector_base(): arr(NULL), inUse(0), allocated(0) {}
+    ~vector_base() {}
+    Derived& derived() {return static_cast<Derived&>(*this);}
+    void swap_storage(vector_base& v) {
+        T* t_arr = v.arr; v.arr = arr; arr = t_arr;
+        size_t t_inUse = v.inUse; v.inUse = inUse; inUse = t_inUse;
+        size_t t_alloc = v.allocated; v.allocated = allocated; allocated = t_alloc;
+    }
+    void reallocate(size_t n);
+    void relocate_to(T* temp, size_t n, size_t gap_at = 0, size_t gap = 0);
+    void relocate_to_new(size_t n, size_t gap_at = 0, size_t gap = 0);
+    size_t next_capacity(size_t needed) const {
+        size_t n = detail::next_capacity<T>(allocated, needed, 1);
+        return (n < 4)? 4: n;
+    }
+    static void destroy(T* first, T* last);
+
+    private:
+    vector_base(const vector_base&);
+    vector_base& operator=(const vector_base&);
+
+    void check_index(size_t val) const {if (val >= inUse) detail::vector_range_error(Derived::name(), val, inUse);}
+    void check_nonempty(const char* caller) const {if (inUse == 0) detail::vector_empty_error(Derived::name(), caller);}
+    void open_gap(size_t pos, size_t n);
+    void close_gap(size_t pos, size_t n);
+    template<class InputIterator>
+    void assign(InputIterator begin, InputIterator end, bool_constant<false>) {clear(); copy(begin, end);}
+    template<class Integer>
+    void assign(Integer n, Integer val, bool_constant<true>) {assign((size_t)n, (T)val);}
+    template<class InputIterator>
+    void insert(iterator it, InputIterator begin, InputIterator end, bool_constant<false>);
+    template<class Integer>
+    void insert(iterator it, Integer val, Integer n, bool_constant<true>) {insert(it, (T)val, (size_t)n);}
+    template<class InputIterator>
+    void insert_range(size_t pos, InputIterator begin, InputIterator end, std::input_iterator_tag);
+    template<class ForwardIterator>
+    void insert_range(size_t pos, ForwardIterator begin, ForwardIterator end, std::forward_iterator_tag);
+};
+
+#if __cplusplus >= 201103L
+template <class T, class D>
+typename my::vector_base<T, D>::iterator my::vector_base<T, D>::insert(iterator it, T&& val) {
+    size_t pos = it.base() - arr;
+    T temp(std::move(val));  // val may live in arr
+    open_gap(pos, 1);
+    new (arr+pos) T(std::move(temp));
+    inUse++;
+    return iterator(arr+pos);
+}
+/* When the vector is full the new element is built in the new block before the old ones are
+ * moved over, so args may safely refer to an element of this vector. */
+template <class T, class D> template <class... Args>
+void my::vector_base<T, D>::emplace_back(Args&&... args) {
+    if (inUse < allocated) {
+        new (arr+inUse) T(std::forward<Args>(args)...);
+    }
+    else if (is_trivially_relocatable<T>::value) {
+        T temp(std::forward<Args>(args)...);
+        reallocate(next_capacity(inUse+1));
+        new (arr+inUse) T(std::move(temp));
+    }
+    else {
+        size_t n = next_capacity(inUse+1);
+        T* temp = derived().allocate(n);
+        try {
+            new (temp+inUse) T(std::forward<Args>(args)...);
+        }
+        catch (...) {
+            derived().deallocate(temp, n);
+            throw;
+        }
+        try {
+            relocate_to(temp, n);
+        }
+        catch (...) {
+            temp[inUse].~T();
+            derived().deallocate(temp, n);
+            throw;
+        }
+    }
+    ++inUse;
+}
+#endif
+
+template <class T, class D> template<class InputIterator>
+void my::vector_base<T, D>::copy(InputIterator begin, InputIterator end) {
+    while (begin != end) {
+        this->push_back(*begin);
+        ++begin;
+    }
+}
+template <class T, class D>
+void my::vector_base<T, D>::assign(size_t n, const T& val) {
+    T temp(val);
+    clear();
+    reserve(n);
+    for (; inUse < n; inUse++)
+        new (arr+inUse) T(temp);
+}
+/* assign(5, 2) picks the InputIterator template over assign(size_t, const T&); the private
+ * assign() sends integers on to the right one */
+template <class T, class D> template<class InputIterator>
+void my::vector_base<T, D>::assign(InputIterator begin, InputIterator end) {
+    assign(begin, end, bool_constant<is_integer<InputIterator>::value>());
+}
+/* Moves the elements to a block of n slots. A trivially relocatable T is moved by
+ * Derived::try_realloc when it can, e.g. realloc of a malloc'd block, which often extends the block
+ * in place; otherwise its bytes are copied to a new block. */
+template <class T, class D>
+void my::vector_base<T, D>::reallocate(size_t n) {
+    if (is_trivially_relocatable<T>::value && n > 0) {
+        T* temp = derived().try_realloc(n);
+        if (temp != NULL) {
+            arr = temp;
+            allocated = n;
+            return;
+        }
+    }
+    relocate_to_new(n);
+}
+/* Moves the elements into temp, a fresh block of n slots, and frees the old block. A trivially
+ * relocatable T is copied as bytes. Other elements are moved when T's move constructor cannot
+ * throw and copied otherwise, so a throwing copy leaves the vector as it was; temp is then the
+ * caller's to free. Elements from gap_at on land gap slots further up, leaving a hole. */
+template <class T, class D>
+void my::vector_base<T, D>::relocate_to(T* temp, size_t n, size_t gap_at, size_t gap) {
+    if (is_trivially_relocatable<T>::value) {
+        if (gap_at > 0) memcpy((void*)temp, (const void*)arr, sizeof(T)*gap_at);
+        if (gap_at < inUse) memcpy((void*)(temp+gap_at+gap), (const void*)(arr+gap_at), sizeof(T)*(inUse-gap_at));
+        derived().deallocate(arr, allocated);
+        arr = temp;
+        allocated = n;
+        return;
+    }
+    size_t i = 0;
+    try {
+        for (; i < inUse; i++)
+        #if __cplusplus >= 201103L
+            new (temp+i+(i >= gap_at? gap: 0)) T(std::move_if_noexcept(arr[i]));
+        #else
+            new (temp+i+(i >= gap_at? gap: 0)) T(arr[i]);
+        #endif
+    }
+    catch (...) {
+        destroy(temp, temp+(i < gap_at? i: gap_at));
+        if (i > gap_at) destroy(temp+gap_at+gap, temp+i+gap);
+        throw;
+    }
+    destroy(arr, arr+inUse);
+    derived().deallocate(arr, allocated);
+    arr = temp;
+    allocated = n;
+}
+/* relocate_to a block of n slots allocated here, and freed again if relocating throws */
+template <class T, class D>
+void my::vector_base<T, D>::relocate_to_new(size_t n, size_t gap_at, size_t gap) {
+    T* temp = derived().allocate(n);
+    try {
+        relocate_to(temp, n, gap_at, gap);
+    }
+    catch (...) {
+        derived().deallocate(temp, n);
+        throw;
+    }
+}
+/* Makes room for n elements at pos: the elements from pos on are moved n slots up, leaving
+ * [pos, pos+n) as raw memory for the caller to construct into. A trivially relocatable tail moves
+ * in one memmove. When the vector must grow into a new block, each element goes straight to its
+ * final slot rather than being moved twice. */
+template <class T, class D>
+void my::vector_base<T, D>::open_gap(size_t pos, size_t n) {
+    if (n == 0)
+        return;
+    if (inUse + n > allocated) {
+        size_t cap = next_capacity(inUse+n);
+        T* temp = is_trivially_relocatable<T>::value? derived().try_realloc(cap): NULL;
+        if (temp == NULL) {
+            relocate_to_new(cap, pos, n);
+            return;
+        }
+        arr = temp;
+        allocated = cap;
+    }
+    if (is_trivially_relocatable<T>::value) {
+        memmove((void*)(arr+pos+n), (const void*)(arr+pos), sizeof(T)*(inUse-pos));
+        return;
+    }
+    for (size_t i = inUse; i > pos; i--) {
+    #if __cplusplus >= 201103L
+        new (arr+i-1+n) T(std::move(arr[i-1]));
+    #else
+        new (arr+i-1+n) T(arr[i-1]);
+    #endif
+        arr[i-1].~T();
+    }
+}
+/* Undoes open_gap(pos, n) when filling the gap failed: [pos, pos+n) must be raw memory again. */
+template <class T, class D>
+void my::vector_base<T, D>::close_gap(size_t pos, size_t n) {
+    if (is_trivially_relocatable<T>::value) {
+        memmove((void*)(arr+pos), (const void*)(arr+pos+n), sizeof(T)*(inUse-pos));
+        return;
+    }
+    for (size_t i = pos; i < inUse; i++) {
+    #if __cplusplus >= 201103L
+        new (arr+i) T(std::move(arr[i+n]));
+    #else
+        new (arr+i) T(arr[i+n]);
+    #endif
+        arr[i+n].~T();
+    }
+}
+template <class T, class D>
+void my::vector_base<T, D>::destroy(T* first, T* last) {
+#if __cplusplus >= 201103L
+    if (std::is_trivially_destructible<T>::value) return;
+#endif
+    for (; first != last; ++first)
+        first->~T();
+}
+template <class T, class D>
+void my::vector_base<T, D>::resize(size_t v, const T& val) {
+    if (v <= inUse) {
+        destroy(arr+v, arr+inUse);
+        inUse = v;
+        return;
+    }
+    if (v > allocated) {
+        T temp(val);  // val may live in arr
+        reallocate(next_capacity(v));
+        for (; inUse < v; inUse++)
+            new (arr+inUse) T(temp);
+        return;
+    }
+    for (; inUse < v; inUse++)
+        new (arr+inUse) T(val);
+}
+template <class T, class D>
+void my::vector_base<T, D>::push_back(const T& val) {
+#if __cplusplus >= 201103L
+    emplace_back(val);
+#else
+    if (inUse == allocated) {
+        T temp(val);  // val may live in arr
+        reallocate(next_capacity(inUse+1));
+        new (arr+inUse++) T(temp);
+        return;
+    }
+    new (arr+inUse++) T(val);
+#endif
+}
+template <class T, class D>
+typename my::vector_base<T, D>::iterator my::vector_base<T, D>::insert(iterator it, const T& val, size_t n) {
+    size_t pos = it.base() - arr;
+    if (n == 0) return it;
+    T temp(val);  // val may live in arr
+    open_gap(pos, n);
+    size_t i = pos;
+    try {
+        for (; i < pos+n; i++)
+            new (arr+i) T(temp);
+    }
+    catch (...) {
+        destroy(arr+pos, arr+i);
+        close_gap(pos, n);
+        throw;
+    }
+    inUse += n;
+    return iterator(arr+pos);
+}
+template <class T, class D> template<class InputIterator>
+void my::vector_base<T, D>::insert(iterator it, InputIterator begin, InputIterator end) {
+    insert(it, begin, end, bool_constant<is_integer<InputIterator>::value>());
+}
+template <class T, class D> template<class InputIterator>
+void my::vector_base<T, D>::insert(iterator it, InputIterator begin, InputIterator end, bool_constant<false>) {
+    insert_range(it.base() - arr, begin, end, typename std::iterator_traits<InputIterator>::iterator_category());
+}
+/* A single pass range cannot be counted first: append it, then rotate it into place. */
+template <class T, class D> template<class InputIterator>
+void my::vector_base<T, D>::insert_range(size_t pos, InputIterator begin, InputIterator end, std::input_iterator_tag) {
+    size_t old = inUse;
+    for (; begin != end; ++begin)
+        push_back(*begin);
+    std::rotate(arr+pos, arr+old, arr+inUse);
+}
+/* Counts the range, opens a gap of that size in one move of the tail and copies the range
+ * straight into it. The range must not come from this vector. */
+template <class T, class D> template<class ForwardIterator>
+void my::vector_base<T, D>::insert_range(size_t pos, ForwardIterator begin, ForwardIterator end, std::forward_iterator_tag) {
+    size_t n = my::distance(begin, end, typename std::iterator_traits<ForwardIterator>::iterator_category());
+    open_gap(pos, n);
+    size_t i = pos;
+    try {
+        for (; i < pos+n; i++, ++begin)
+            new (arr+i) T(*begin);
+    }
+    catch (...) {
+        destroy(arr+pos, arr+i);
+        close_gap(pos, n);
+        throw;
+    }
+    inUse += n;
+}
+/* A trivially relocatable tail is moved down with one memmove; otherwise it is move assigned
+ * element by element and the leftover tail destroyed. */
+template <class T, class D>
+void my::vector_base<T, D>::erase(iterator begin, iterator end) {
+    size_t n = end - begin, pos = begin.base() - arr;
+    if (n == 0)
+        return;
+    if (is_trivially_relocatable<T>::value) {
+        destroy(arr+pos, arr+pos+n);
+        memmove((void*)(arr+pos), (const void*)(arr+pos+n), sizeof(T)*(inUse-pos-n));
+    }
+    else {
+        for (size_t i = pos; i < inUse-n; i++)
+            detail::move_assign(arr[i], arr[i+n]);
+        destroy(arr+inUse-n, arr+inUse);
+    }
+    inUse -= n;
+}
+template <class T, class D>
+void my::vector_base<T, D>::eraseAll(const T& val) {
+    if (inUse == 0)
+        return;
+    T temp(val);  // val may live in arr and be moved from below
+    T* end = my::remove(arr, arr+inUse, temp);
+    destroy(end, arr+inUse);
+    inUse = end - arr;
+}
+template <class T, class D> template <class Predicate>
+void my::vector_base<T, D>::eraseIf(Predicate pred) {
+    T* end = detail::remove_if(arr, arr+inUse, pred);
+    destroy(end, arr+inUse);
+    inUse = end - arr;
+}
+template <class T, class D>
+std::ostream& my::operator << ( std::ostream& os, const my::vector_base<T, D>& v ) {
+    os << "[ ";
+    for (size_t i = 0; i < v.size(); i++)
+        os << v[i] << " ";
+    os << "]" << std::endl;
+    return os;
+}
+template <class T, class D>
+bool operator==(const my::vector_base<T, D>& v1, const my::vector_base<T, D>& v2) {
+    if (v1.size() != v2.size())
+        return false;
+    for (size_t i = 0; i < v1.size(); i++) {
+        if (v1[i] != v2[i])
+            return false;
+    }
+    return true;
+}
+template <class T, class D>
+bool operator!=(const my::vector_base<T, D>& v1, const my::vector_base<T, D>& v2) {
+    return !(v1 == v2);
+}
+template <class T, class D>
+bool operator<(const my::vector_base<T, D>& v1, const my::vector_base<T, D>& v2) {
+    return(my::lexicographicalCompare(v1.begin(), v1.end(), v2.begin(), v2.end()));
+}
+template <class T, class D>
+bool operator<=(const my::vector_base<T, D>& v1, const my::vector_base<T, D>& v2) {
+    return !(v2 < v1);
+}
+template <class T, class D>
+bool operator>(const my::vector_base<T, D>& v1, const my::vector_base<T, D>& v2) {
+    return v2 < v1;
+}
+template <class T, class D>
+bool operator>=(const my::vector_base<T, D>& v1, const my::vector_base<T, D>& v2) {
+    return !(v1 < v2);
+}
+
+#endif